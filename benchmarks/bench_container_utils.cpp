@@ -0,0 +1,373 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <numeric>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "bench_helpers.h"
+#include "containerutils.h"
+
+// every benchmark has a std counterpart, named "std ...", written the way one would without the library
+
+namespace {
+// only orderable, so remove_duplicates has to take the sorting path
+struct less_only_type {
+    int m_val;
+
+    friend bool operator<(const less_only_type& lhs, const less_only_type& rhs) {
+        return lhs.m_val < rhs.m_val;
+    }
+};
+
+template <typename T>
+auto make_shards(const std::vector<int>& ints, std::size_t count) {
+    auto out = std::vector<std::vector<T>>(count);
+    for (std::size_t i = 0; i < ints.size(); ++i)
+        push_value(out[i % count], ints[i]);
+    return out;
+}
+} // namespace
+
+TEMPLATE_TEST_CASE("bench_filter()", "[benchmark]", int, double, std::string, move_only_type, copy_only_type) {
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{100'000});
+    const auto ints = random_ints(n, n);
+    const auto even = [](const TestType& t) { return int_value(t) % 2 == 0; };
+    if constexpr (std::is_copy_constructible_v<TestType>) {
+        const auto values = make_values<TestType>(ints);
+        BENCHMARK(bench_name("filter", type_name<TestType>(), n)) {
+            return mleivo::cu::filter(values, even);
+        };
+        BENCHMARK(bench_name("std copy_if", type_name<TestType>(), n)) {
+            auto out = std::vector<TestType>{};
+            std::copy_if(values.begin(), values.end(), std::back_inserter(out), even);
+            return out;
+        };
+        auto reused = std::vector<TestType>{};
+        BENCHMARK(bench_name("filter_into reused buffer", type_name<TestType>(), n)) {
+            reused.clear();
+            return mleivo::cu::filter_into(reused, values, even).size();
+        };
+    } else {
+        const auto make = [&ints] { return make_values<TestType>(ints); };
+        bench_fresh(bench_name("filter rvalue", type_name<TestType>(), n), make,
+                    [&](auto& v) { return mleivo::cu::filter(std::move(v), even); });
+        bench_fresh(bench_name("std copy_if rvalue", type_name<TestType>(), n), make, [&](auto& v) {
+            auto out = std::vector<TestType>{};
+            std::copy_if(std::make_move_iterator(v.begin()), std::make_move_iterator(v.end()), std::back_inserter(out),
+                         even);
+            return out;
+        });
+    }
+}
+
+TEMPLATE_TEST_CASE("bench_transform()", "[benchmark]", int, double, std::string, move_only_type, copy_only_type) {
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{100'000});
+    const auto ints = random_ints(n, n);
+    const auto to_int = [](const TestType& t) { return int_value(t) + 1; };
+    const auto values = make_values<TestType>(ints);
+    BENCHMARK(bench_name("transform to int", type_name<TestType>(), n)) {
+        return mleivo::cu::transform(values, to_int);
+    };
+    BENCHMARK(bench_name("std transform to int", type_name<TestType>(), n)) {
+        auto out = std::vector<int>{};
+        std::transform(values.begin(), values.end(), std::back_inserter(out), to_int);
+        return out;
+    };
+    if constexpr (std::is_move_assignable_v<TestType>) {
+        const auto make = [&ints] { return make_values<TestType>(ints); };
+        const auto bump = [](TestType&& t) { return bumped(std::move(t)); };
+        bench_fresh(bench_name("transform rvalue in place", type_name<TestType>(), n), make,
+                    [&](auto& v) { return mleivo::cu::transform(std::move(v), bump); });
+        bench_fresh(bench_name("std transform in place", type_name<TestType>(), n), make, [&](auto& v) {
+            std::transform(std::make_move_iterator(v.begin()), std::make_move_iterator(v.end()), v.begin(), bump);
+            return v.size();
+        });
+    }
+}
+
+TEMPLATE_TEST_CASE("bench_merge()", "[benchmark]", int, double, std::string, move_only_type, copy_only_type) {
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{100'000});
+    const auto ints = random_ints(n, n);
+    const auto make = [&ints] { return make_shards<TestType>(ints, 8); };
+    bench_fresh(bench_name("merge 8 rvalues", type_name<TestType>(), n), make, [](auto& s) {
+        return mleivo::cu::merge(std::move(s[0]), std::move(s[1]), std::move(s[2]), std::move(s[3]), std::move(s[4]),
+                                 std::move(s[5]), std::move(s[6]), std::move(s[7]));
+    });
+    bench_fresh(bench_name("std insert 8 rvalues", type_name<TestType>(), n), make, [](auto& shards) {
+        auto out = std::vector<TestType>{};
+        for (auto& s : shards) {
+            if constexpr (std::is_move_constructible_v<TestType>)
+                out.insert(out.end(), std::make_move_iterator(s.begin()), std::make_move_iterator(s.end()));
+            else
+                std::copy(s.begin(), s.end(), std::back_inserter(out));
+        }
+        return out;
+    });
+
+    if constexpr (!std::is_same_v<TestType, copy_only_type>) {
+        const auto make_sorted = [&ints] {
+            auto shards = make_shards<TestType>(ints, 64);
+            for (auto& s : shards)
+                std::sort(s.begin(), s.end());
+            return shards;
+        };
+        bench_fresh(bench_name("merge_sorted 64 shards", type_name<TestType>(), n), make_sorted,
+                    [](auto& shards) { return mleivo::cu::merge_sorted(std::move(shards)); });
+        bench_fresh(bench_name("std sort 64 shards", type_name<TestType>(), n), make_sorted, [](auto& shards) {
+            auto out = std::vector<TestType>{};
+            for (auto& s : shards)
+                out.insert(out.end(), std::make_move_iterator(s.begin()), std::make_move_iterator(s.end()));
+            std::stable_sort(out.begin(), out.end());
+            return out;
+        });
+    }
+}
+
+TEST_CASE("bench_split()", "[benchmark]") {
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{100'000});
+    auto text = std::string{};
+    for (auto i : random_ints(n / 8, 1000))
+        text += std::to_string(i) + ',';
+
+    BENCHMARK(bench_name("split", "string", text.size())) {
+        return mleivo::cu::split(text, ',');
+    };
+    BENCHMARK(bench_name("split small_vector pieces", "string", text.size())) {
+        return mleivo::cu::split<std::vector<mleivo::cu::small_vector<char, 8>>>(text, ',');
+    };
+    BENCHMARK(bench_name("split_view", "string", text.size())) {
+        auto sum = std::size_t{0};
+        for (auto piece : mleivo::cu::split_view(text, ','))
+            sum += piece.size();
+        return sum;
+    };
+    BENCHMARK(bench_name("std find loop", "string", text.size())) {
+        auto sum = std::size_t{0};
+        const auto view = std::string_view(text);
+        for (std::size_t first = 0;;) {
+            const auto last = view.find(',', first);
+            sum += (last == std::string_view::npos ? view.size() : last) - first;
+            if (last == std::string_view::npos)
+                break;
+            first = last + 1;
+        }
+        return sum;
+    };
+}
+
+// the hashed and the sorted strategy scale from 1e3 to 1e7 on ints, the other value types stop at 1e6
+TEMPLATE_TEST_CASE("bench_remove_duplicates()", "[benchmark]", int, double, std::string, move_only_type) {
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{10'000}, std::size_t{100'000}, std::size_t{1'000'000},
+                            std::size_t{10'000'000});
+    if (!std::is_same_v<TestType, int> && n > 1'000'000)
+        return;
+    const auto ints = random_ints(n, n / 2);
+    const auto make = [&ints] { return make_values<TestType>(ints); };
+    bench_fresh(bench_name("remove_duplicates", type_name<TestType>(), n), make, [](auto& v) {
+        mleivo::cu::remove_duplicates(v);
+        return v.size();
+    });
+    if constexpr (std::is_copy_constructible_v<TestType>) {
+        bench_fresh(bench_name("std unordered_set", type_name<TestType>(), n), make, [](auto& v) {
+            auto seen = std::unordered_set<TestType>{};
+            v.erase(std::remove_if(v.begin(), v.end(), [&seen](const auto& e) { return !seen.insert(e).second; }),
+                    v.end());
+            return v.size();
+        });
+    }
+    if (std::is_same_v<TestType, int>) {
+        const auto make_less_only = [&ints] {
+            auto out = std::vector<less_only_type>{};
+            for (auto i : ints)
+                out.push_back({i});
+            return out;
+        };
+        bench_fresh(bench_name("remove_duplicates sorted", "less_only_type", n), make_less_only, [](auto& v) {
+            mleivo::cu::remove_duplicates(v);
+            return v.size();
+        });
+    }
+    if (n <= 1'000) {
+        bench_fresh(bench_name("remove_duplicates custom comparator", type_name<TestType>(), n), make, [](auto& v) {
+            mleivo::cu::remove_duplicates(v, std::equal_to{});
+            return v.size();
+        });
+    }
+}
+
+TEMPLATE_TEST_CASE("bench_contains()", "[benchmark]", std::int8_t, int, double, std::string) {
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{100'000});
+    // the value is missing, so the whole container is searched
+    const auto values = make_values<TestType>(std::vector<int>(n, 7));
+    const auto missing = make_value<TestType>(8);
+    BENCHMARK(bench_name("contains", type_name<TestType>(), n)) {
+        return mleivo::cu::contains(values, missing);
+    };
+    BENCHMARK(bench_name("index_of", type_name<TestType>(), n)) {
+        return mleivo::cu::index_of(values, missing);
+    };
+    BENCHMARK(bench_name("std loop", type_name<TestType>(), n)) {
+        for (const auto& v : values) {
+            if (v == missing)
+                return true;
+        }
+        return false;
+    };
+}
+
+TEMPLATE_TEST_CASE("bench_flat_set_lookup()", "[benchmark]", int, std::string) {
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{100'000});
+    const auto ints = random_ints(n, n);
+    const auto values = make_values<TestType>(ints);
+    const auto probes = make_values<TestType>(random_ints(1'000, n));
+    const auto flat = mleivo::cu::flat_set<TestType>(values.begin(), values.end());
+    const auto node = std::set<TestType>(values.begin(), values.end());
+    BENCHMARK(bench_name("flat_set contains x1000", type_name<TestType>(), n)) {
+        auto found = std::size_t{0};
+        for (const auto& p : probes)
+            found += mleivo::cu::contains(flat, p);
+        return found;
+    };
+    BENCHMARK(bench_name("std set count x1000", type_name<TestType>(), n)) {
+        auto found = std::size_t{0};
+        for (const auto& p : probes)
+            found += node.count(p);
+        return found;
+    };
+    BENCHMARK(bench_name("std binary_search x1000", type_name<TestType>(), n)) {
+        auto found = std::size_t{0};
+        for (const auto& p : probes)
+            found += std::binary_search(flat.begin(), flat.end(), p);
+        return found;
+    };
+    BENCHMARK(bench_name("flat_set bulk insert", type_name<TestType>(), n)) {
+        auto s = mleivo::cu::flat_set<TestType>{};
+        s.insert(values.begin(), values.end());
+        return s.size();
+    };
+    BENCHMARK(bench_name("std set insert", type_name<TestType>(), n)) {
+        auto s = std::set<TestType>{};
+        s.insert(values.begin(), values.end());
+        return s.size();
+    };
+}
+
+TEST_CASE("bench_static_map_lookup()", "[benchmark]") {
+    // a protocol decoder's field table, probed with the field names of a message and some unknown ones
+    static constexpr auto fields = mleivo::cu::make_static_map<std::string_view, int>(
+        {{"id", 0}, {"type", 1}, {"name", 2}, {"price", 3}, {"quantity", 4}, {"side", 5}, {"account", 6},
+         {"symbol", 7}, {"timestamp", 8}, {"venue", 9}, {"currency", 10}, {"status", 11}, {"order_id", 12},
+         {"client_id", 13}, {"tif", 14}, {"flags", 15}});
+    const auto hashed = std::unordered_map<std::string_view, int>(fields.begin(), fields.end());
+    const auto sorted = mleivo::cu::flat_map<std::string_view, int>(fields.begin(), fields.end());
+    auto probes = std::vector<std::string>{};
+    for (const auto i : random_ints(1'000, 20)) {
+        const auto j = static_cast<std::size_t>(i);
+        probes.push_back(j < fields.size() ? std::string(fields.begin()[j].first) : "unknown_" + std::to_string(j));
+    }
+    BENCHMARK("static_map find x1000") {
+        auto sum = 0;
+        for (const auto& p : probes) {
+            const auto it = fields.find(p);
+            sum += it != fields.end() ? it->second : -1;
+        }
+        return sum;
+    };
+    BENCHMARK("flat_map find x1000") {
+        auto sum = 0;
+        for (const auto& p : probes) {
+            const auto it = sorted.find(p);
+            sum += it != sorted.end() ? (*it).second : -1;
+        }
+        return sum;
+    };
+    BENCHMARK("std unordered_map find x1000") {
+        auto sum = 0;
+        for (const auto& p : probes) {
+            const auto it = hashed.find(p);
+            sum += it != hashed.end() ? it->second : -1;
+        }
+        return sum;
+    };
+}
+
+TEMPLATE_TEST_CASE("bench_enumerate()", "[benchmark]", int, double) {
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{1'000'000});
+    auto values = make_values<TestType>(random_ints(n, 100));
+    BENCHMARK(bench_name("enumerate", type_name<TestType>(), n)) {
+        auto sum = TestType{};
+        for (auto&& [i, e] : mleivo::cu::enumerate(values))
+            sum += static_cast<TestType>(i) * e;
+        return sum;
+    };
+    BENCHMARK(bench_name("for_each_enumerated", type_name<TestType>(), n)) {
+        mleivo::cu::for_each_enumerated(values, [](std::size_t i, TestType& x) { x = static_cast<TestType>(i); });
+        return values.back();
+    };
+    BENCHMARK(bench_name("std index loop", type_name<TestType>(), n)) {
+        auto sum = TestType{};
+        for (std::size_t i = 0; i < values.size(); ++i)
+            sum += static_cast<TestType>(i) * values[i];
+        return sum;
+    };
+}
+
+TEST_CASE("bench_irange()", "[benchmark]") {
+    const auto n = GENERATE(std::int64_t{1'000}, std::int64_t{10'000'000});
+    BENCHMARK(bench_name("irange", "int64", static_cast<std::size_t>(n))) {
+        auto sum = std::int64_t{0};
+        for (auto i : mleivo::cu::irange(std::int64_t{0}, n, std::int64_t{3}))
+            sum += i;
+        return sum;
+    };
+    BENCHMARK(bench_name("irange std::reduce par", "int64", static_cast<std::size_t>(n))) {
+        const auto r = mleivo::cu::irange(std::int64_t{0}, n, std::int64_t{3});
+        return std::reduce(std::execution::par, r.begin(), r.end(), std::int64_t{0});
+    };
+    BENCHMARK(bench_name("std for loop", "int64", static_cast<std::size_t>(n))) {
+        auto sum = std::int64_t{0};
+        for (auto i = std::int64_t{0}; i < n; i += 3)
+            sum += i;
+        return sum;
+    };
+}
+
+TEST_CASE("bench_static_cast_all()", "[benchmark]") {
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{1'000'000}, std::size_t{10'000'000});
+    const auto ints = random_ints(n, n);
+    const auto floats = mleivo::cu::static_cast_all<float>(ints);
+    const auto doubles = mleivo::cu::static_cast_all<double>(ints);
+    const auto wide = mleivo::cu::static_cast_all<std::int64_t>(ints);
+
+    BENCHMARK(bench_name("static_cast_all int32 -> float", "int", n)) {
+        return mleivo::cu::static_cast_all<float>(ints);
+    };
+    BENCHMARK(bench_name("std transform int32 -> float", "int", n)) {
+        auto out = std::vector<float>{};
+        std::transform(ints.begin(), ints.end(), std::back_inserter(out), [](int i) { return static_cast<float>(i); });
+        return out;
+    };
+    BENCHMARK(bench_name("static_cast_all float -> int32", "float", n)) {
+        return mleivo::cu::static_cast_all<std::int32_t>(floats);
+    };
+    BENCHMARK(bench_name("static_cast_all float -> int32 saturating", "float", n)) {
+        return mleivo::cu::static_cast_all<std::int32_t>(floats, mleivo::cu::saturate);
+    };
+    BENCHMARK(bench_name("static_cast_all double -> float", "double", n)) {
+        return mleivo::cu::static_cast_all<float>(doubles);
+    };
+    BENCHMARK(bench_name("static_cast_all int64 -> int32 saturating", "int64", n)) {
+        return mleivo::cu::static_cast_all<std::int32_t>(wide, mleivo::cu::saturate);
+    };
+}
@@ -0,0 +1,77 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_helpers.h"
+#include "pipes.h"
+#include "thread_pool.h"
+
+// the scheduler on 1, 2, 4, ... up to every hardware thread, the same work each time, to show how it scales
+
+namespace {
+std::vector<std::size_t> thread_counts() {
+    const auto hardware = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    auto out = std::vector<std::size_t>{};
+    for (std::size_t t = 1; t < hardware; t *= 2)
+        out.push_back(t);
+    out.push_back(hardware);
+    return out;
+}
+
+std::string threads_name(const char* what, std::size_t threads, std::size_t n) {
+    return std::string(what) + " threads " + std::to_string(threads) + " n " + std::to_string(n);
+}
+} // namespace
+
+TEST_CASE("bench_exec_scaling()", "[benchmark]") {
+    const auto threads = GENERATE(from_range(thread_counts()));
+    const auto n = std::size_t{4'000'000};
+    auto pool = mleivo::exec::thread_pool(threads);
+    auto values = std::vector<double>(n);
+    for (std::size_t i = 0; i < n; ++i)
+        values[i] = static_cast<double>(i % 1000) * 0.001;
+
+    BENCHMARK(threads_name("parallel_for", threads, n)) {
+        mleivo::exec::parallel_for(
+            pool, 0, n, [&values](std::size_t i) { values[i] = std::sqrt(values[i] + 1.0); }, 4096);
+        return values[n / 2];
+    };
+    BENCHMARK(threads_name("parallel_reduce", threads, n)) {
+        return mleivo::exec::parallel_reduce(
+            pool, 0, n, 0.0,
+            [&values](std::size_t first, std::size_t last, double acc) {
+                for (auto i = first; i < last; ++i)
+                    acc += values[i];
+                return acc;
+            },
+            std::plus<>{}, 4096);
+    };
+    const auto ints = random_ints(n / 4, n);
+    bench_fresh(threads_name("parallel stable_sort", threads, ints.size()), [&ints] { return ints; }, [&](auto& v) {
+        auto comp = std::less<>{};
+        mleivo::pipes::detail::parallel_sort<true>(pool, v.begin(), v.end(), comp);
+        return v.size();
+    });
+    BENCHMARK(threads_name("fork_join tree", threads, 1 << 16)) {
+        const std::function<std::size_t(std::size_t)> tree = [&](std::size_t leaves) -> std::size_t {
+            if (leaves == 1)
+                return 1;
+            auto a = std::size_t{0};
+            auto b = std::size_t{0};
+            pool.fork_join([&] { a = tree(leaves / 2); }, [&] { b = tree(leaves - leaves / 2); });
+            return a + b;
+        };
+        auto out = std::size_t{0};
+        pool.run([&] { out = tree(1 << 16); });
+        return out;
+    };
+}
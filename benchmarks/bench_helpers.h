@@ -0,0 +1,110 @@
+#pragma once
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "helpers.h"
+
+// the element types every benchmark runs with, made from ints so that equal ints make equal values
+template <typename T>
+T make_value(int i) {
+    if constexpr (std::is_same_v<T, std::string>)
+        return "a string long enough to live on the heap " + std::to_string(i);
+    else if constexpr (std::is_arithmetic_v<T>)
+        return static_cast<T>(i);
+    else
+        return T(i);
+}
+
+template <typename T>
+int int_value(const T& t) {
+    if constexpr (std::is_same_v<T, std::string>)
+        return static_cast<int>(t.size());
+    else if constexpr (std::is_same_v<T, move_only_type>)
+        return *t.m_val;
+    else if constexpr (std::is_same_v<T, copy_only_type>)
+        return t.m_val;
+    else
+        return static_cast<int>(t);
+}
+
+// a new value made from t, cheap but not free so the compiler cannot drop a loop of them
+template <typename T>
+T bumped(T&& t) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        t.push_back('x');
+        return std::move(t);
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        return t + 1;
+    } else {
+        return T(int_value(t) + 1);
+    }
+}
+
+template <typename T>
+const char* type_name() {
+    if constexpr (std::is_same_v<T, std::int8_t>)
+        return "int8";
+    else if constexpr (std::is_same_v<T, int>)
+        return "int";
+    else if constexpr (std::is_same_v<T, double>)
+        return "double";
+    else if constexpr (std::is_same_v<T, std::string>)
+        return "string";
+    else if constexpr (std::is_same_v<T, move_only_type>)
+        return "move_only_type";
+    else if constexpr (std::is_same_v<T, copy_only_type>)
+        return "copy_only_type";
+    else
+        return "other";
+}
+
+// n values drawn from [0, distinct)
+inline std::vector<int> random_ints(std::size_t n, std::size_t distinct) {
+    auto rng = std::mt19937{42};
+    auto dist = std::uniform_int_distribution<int>(0, static_cast<int>(distinct) - 1);
+    auto out = std::vector<int>(n);
+    for (auto& i : out)
+        i = dist(rng);
+    return out;
+}
+
+template <typename T>
+void push_value(std::vector<T>& out, int i) {
+    if constexpr (std::is_move_constructible_v<T>) {
+        out.push_back(make_value<T>(i));
+    } else {
+        const auto value = make_value<T>(i);
+        out.push_back(value);
+    }
+}
+
+template <typename T>
+std::vector<T> make_values(const std::vector<int>& ints) {
+    auto out = std::vector<T>{};
+    out.reserve(ints.size());
+    for (auto i : ints)
+        push_value(out, i);
+    return out;
+}
+
+inline std::string bench_name(const std::string& what, const char* type, std::size_t n) {
+    return what + " " + type + " " + std::to_string(n);
+}
+
+// runs f on a fresh input per run, made outside of the measurement, for the functions that consume or modify it
+template <typename MakeT, typename F>
+void bench_fresh(const std::string& name, MakeT&& make, F&& f) {
+    BENCHMARK_ADVANCED(name.c_str())(Catch::Benchmark::Chronometer meter) {
+        auto inputs = std::vector<decltype(make())>{};
+        inputs.reserve(static_cast<std::size_t>(meter.runs()));
+        for (int i = 0; i < meter.runs(); ++i)
+            inputs.push_back(make());
+        meter.measure([&](int i) { return f(inputs[i]); });
+    };
+}
@@ -0,0 +1,382 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_helpers.h"
+#include "pipes.h"
+
+// every stage is measured next to the std algorithm it wraps, named "std ...", to show the cost of the pipe itself
+
+namespace {
+// a fresh copy of values per run, for the stages that modify their input
+template <typename T, typename PipeF, typename StdF>
+void bench_mutating(const std::string& what, const std::vector<T>& values, PipeF&& pipe_f, StdF&& std_f) {
+    const auto make = [&values] { return values; };
+    bench_fresh(bench_name("pipe " + what, type_name<T>(), values.size()), make, [&](auto& v) {
+        pipe_f(v);
+        return v.size();
+    });
+    bench_fresh(bench_name("std " + what, type_name<T>(), values.size()), make, [&](auto& v) {
+        std_f(v);
+        return v.size();
+    });
+}
+} // namespace
+
+TEMPLATE_TEST_CASE("bench_pipe_mutating()", "[benchmark]", int, double, std::string) {
+    namespace pipes = mleivo::pipes;
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{100'000});
+    const auto values = make_values<TestType>(random_ints(n, n));
+    const auto pivot = make_value<TestType>(static_cast<int>(n / 2));
+    const auto small = [pivot](const TestType& t) { return t < pivot; };
+    const auto mid = static_cast<std::ptrdiff_t>(n / 2);
+
+    bench_mutating("sort", values, [](auto& v) { v | pipes::sort(); }, [](auto& v) { std::sort(v.begin(), v.end()); });
+    bench_mutating(
+        "sort par", values, [](auto& v) { v | pipes::par | pipes::sort(); },
+        [](auto& v) { std::sort(std::execution::par, v.begin(), v.end()); });
+    bench_mutating(
+        "stable_sort", values, [](auto& v) { v | pipes::stable_sort(); },
+        [](auto& v) { std::stable_sort(v.begin(), v.end()); });
+    bench_mutating(
+        "stable_sort par", values, [](auto& v) { v | pipes::par | pipes::stable_sort(); },
+        [](auto& v) { std::stable_sort(std::execution::par, v.begin(), v.end()); });
+    bench_mutating(
+        "partition", values, [&](auto& v) { v | pipes::partition(small); },
+        [&](auto& v) { std::partition(v.begin(), v.end(), small); });
+    bench_mutating(
+        "stable_partition", values, [&](auto& v) { v | pipes::stable_partition(small); },
+        [&](auto& v) { std::stable_partition(v.begin(), v.end(), small); });
+    bench_mutating(
+        "nth_element", values, [&](auto& v) { v | pipes::nth_element(mid); },
+        [&](auto& v) { std::nth_element(v.begin(), v.begin() + mid, v.end()); });
+    bench_mutating(
+        "partial_sort", values, [&](auto& v) { v | pipes::partial_sort(mid); },
+        [&](auto& v) { std::partial_sort(v.begin(), v.begin() + mid, v.end()); });
+    bench_mutating("reverse", values, [](auto& v) { v | pipes::reverse(); },
+                   [](auto& v) { std::reverse(v.begin(), v.end()); });
+    bench_mutating(
+        "fill", values, [&](auto& v) { v | pipes::fill(pivot); }, [&](auto& v) { std::fill(v.begin(), v.end(), pivot); });
+    bench_mutating(
+        "replace", values, [&](auto& v) { v | pipes::replace(pivot, values.front()); },
+        [&](auto& v) { std::replace(v.begin(), v.end(), pivot, values.front()); });
+    bench_mutating(
+        "replace_if", values, [&](auto& v) { v | pipes::replace_if(small, pivot); },
+        [&](auto& v) { std::replace_if(v.begin(), v.end(), small, pivot); });
+    bench_mutating(
+        "for_each", values, [](auto& v) { v | pipes::for_each([](TestType& t) { t = t + t; }); },
+        [](auto& v) { std::for_each(v.begin(), v.end(), [](TestType& t) { t = t + t; }); });
+}
+
+TEMPLATE_TEST_CASE("bench_pipe_queries()", "[benchmark]", int, double, std::string) {
+    namespace pipes = mleivo::pipes;
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{100'000});
+    const auto values = make_values<TestType>(random_ints(n, n));
+    const auto missing = make_value<TestType>(static_cast<int>(n) + 1);
+    const auto is_missing = [&missing](const TestType& t) { return t == missing; };
+    const auto name = [n](const char* what) { return bench_name(what, type_name<TestType>(), n); };
+
+    BENCHMARK(name("pipe all_of")) {
+        return values | pipes::all_of([&](const TestType& t) { return !is_missing(t); });
+    };
+    BENCHMARK(name("std all_of")) {
+        return std::all_of(values.begin(), values.end(), [&](const TestType& t) { return !is_missing(t); });
+    };
+    BENCHMARK(name("pipe any_of")) {
+        return values | pipes::any_of(is_missing);
+    };
+    BENCHMARK(name("std any_of")) {
+        return std::any_of(values.begin(), values.end(), is_missing);
+    };
+    BENCHMARK(name("pipe none_of")) {
+        return values | pipes::none_of(is_missing);
+    };
+    BENCHMARK(name("std none_of")) {
+        return std::none_of(values.begin(), values.end(), is_missing);
+    };
+    BENCHMARK(name("pipe count")) {
+        return values | pipes::count(missing);
+    };
+    BENCHMARK(name("std count")) {
+        return std::count(values.begin(), values.end(), missing);
+    };
+    BENCHMARK(name("pipe count_if")) {
+        return values | pipes::count_if(is_missing);
+    };
+    BENCHMARK(name("std count_if")) {
+        return std::count_if(values.begin(), values.end(), is_missing);
+    };
+    BENCHMARK(name("pipe find")) {
+        return values | pipes::find(missing);
+    };
+    BENCHMARK(name("std find")) {
+        return std::find(values.begin(), values.end(), missing);
+    };
+    BENCHMARK(name("pipe find_if")) {
+        return values | pipes::find_if(is_missing);
+    };
+    BENCHMARK(name("std find_if")) {
+        return std::find_if(values.begin(), values.end(), is_missing);
+    };
+    BENCHMARK(name("pipe is_sorted")) {
+        return values | pipes::is_sorted();
+    };
+    BENCHMARK(name("std is_sorted")) {
+        return std::is_sorted(values.begin(), values.end());
+    };
+    BENCHMARK(name("pipe max_element")) {
+        return values | pipes::max_element();
+    };
+    BENCHMARK(name("std max_element")) {
+        return std::max_element(values.begin(), values.end());
+    };
+    BENCHMARK(name("pipe min_element")) {
+        return values | pipes::min_element();
+    };
+    BENCHMARK(name("std min_element")) {
+        return std::min_element(values.begin(), values.end());
+    };
+    BENCHMARK(name("pipe minmax_element")) {
+        return values | pipes::minmax_element();
+    };
+    BENCHMARK(name("std minmax_element")) {
+        return std::minmax_element(values.begin(), values.end());
+    };
+}
+
+TEMPLATE_TEST_CASE("bench_pipe_numeric()", "[benchmark]", int, double) {
+    namespace pipes = mleivo::pipes;
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{1'000'000});
+    const auto values = make_values<TestType>(random_ints(n, 100));
+    const auto name = [n](const char* what) { return bench_name(what, type_name<TestType>(), n); };
+    const auto square = [](TestType t) { return t * t; };
+
+    BENCHMARK(name("pipe accumulate")) {
+        return values | pipes::accumulate(TestType{}, std::plus<>{});
+    };
+    BENCHMARK(name("std accumulate")) {
+        return std::accumulate(values.begin(), values.end(), TestType{});
+    };
+    BENCHMARK(name("pipe reduce")) {
+        return values | pipes::reduce(TestType{}, std::plus<>{});
+    };
+    BENCHMARK(name("pipe reduce par")) {
+        return values | pipes::par | pipes::reduce(TestType{}, std::plus<>{});
+    };
+    BENCHMARK(name("std reduce")) {
+        return std::reduce(values.begin(), values.end(), TestType{});
+    };
+    BENCHMARK(name("pipe transform_reduce")) {
+        return values | pipes::transform_reduce(TestType{}, std::plus<>{}, square);
+    };
+    BENCHMARK(name("std transform_reduce")) {
+        return std::transform_reduce(values.begin(), values.end(), TestType{}, std::plus<>{}, square);
+    };
+    bench_mutating(
+        "inclusive_scan", values, [](auto& v) { v | pipes::inclusive_scan(); },
+        [](auto& v) { std::inclusive_scan(v.begin(), v.end(), v.begin()); });
+}
+
+TEMPLATE_TEST_CASE("bench_pipe_views()", "[benchmark]", int, double) {
+    namespace pipes = mleivo::pipes;
+    const auto n = GENERATE(std::size_t{1'000}, std::size_t{1'000'000});
+    const auto values = make_values<TestType>(random_ints(n, 100));
+    const auto name = [n](const char* what) { return bench_name(what, type_name<TestType>(), n); };
+    const auto small = [](TestType t) { return t < TestType{50}; };
+    const auto square = [](TestType t) { return t * t; };
+
+    BENCHMARK(name("pipe filter | transform | to")) {
+        return values | pipes::filter(small) | pipes::transform(square) | pipes::to<std::vector<TestType>>();
+    };
+    BENCHMARK(name("std filter and transform loop")) {
+        auto out = std::vector<TestType>{};
+        for (auto v : values) {
+            if (small(v))
+                out.push_back(square(v));
+        }
+        return out;
+    };
+    BENCHMARK(name("pipe filter | transform | accumulate")) {
+        return values | pipes::filter(small) | pipes::transform(square) | pipes::accumulate(TestType{}, std::plus<>{});
+    };
+    BENCHMARK(name("std filter and transform sum")) {
+        auto sum = TestType{};
+        for (auto v : values) {
+            if (small(v))
+                sum += square(v);
+        }
+        return sum;
+    };
+    BENCHMARK(name("pipe take_while | to")) {
+        return values | pipes::take_while([](TestType t) { return t < TestType{99}; })
+               | pipes::to<std::vector<TestType>>();
+    };
+    BENCHMARK(name("pipe drop_while | to")) {
+        return values | pipes::drop_while([](TestType t) { return t < TestType{99}; })
+               | pipes::to<std::vector<TestType>>();
+    };
+    BENCHMARK(name("std find_if and copy")) {
+        const auto first = std::find_if(values.begin(), values.end(), [](TestType t) { return !(t < TestType{99}); });
+        return std::vector<TestType>(first, values.end());
+    };
+}
+
+TEST_CASE("bench_pipe_radix_sort()", "[benchmark]") {
+    namespace pipes = mleivo::pipes;
+    // records sorted by their 64-bit id
+    struct record {
+        std::uint64_t id;
+        std::uint64_t payload;
+    };
+    const auto n = GENERATE(std::size_t{100'000}, std::size_t{1'000'000});
+    auto rng = std::mt19937_64{42};
+    auto records = std::vector<record>(n);
+    for (auto& r : records)
+        r = {rng(), rng()};
+    const auto make = [&records] { return records; };
+    const auto id = [](const record& r) { return r.id; };
+    const auto by_id = [](const record& a, const record& b) { return a.id < b.id; };
+    const auto name = [n](const char* what) { return bench_name(what, "record", n); };
+
+    bench_fresh(name("pipe radix_sort"), make, [&](auto& v) {
+        v | pipes::radix_sort(id);
+        return v.size();
+    });
+    bench_fresh(name("pipe radix_sort<11>"), make, [&](auto& v) {
+        v | pipes::radix_sort<11>(id);
+        return v.size();
+    });
+    bench_fresh(name("pipe radix_sort<16>"), make, [&](auto& v) {
+        v | pipes::radix_sort<16>(id);
+        return v.size();
+    });
+    bench_fresh(name("pipe radix_sort par"), make, [&](auto& v) {
+        v | pipes::par | pipes::radix_sort(id);
+        return v.size();
+    });
+    bench_fresh(name("std sort"), make, [&](auto& v) {
+        std::sort(v.begin(), v.end(), by_id);
+        return v.size();
+    });
+    bench_fresh(name("std stable_sort"), make, [&](auto& v) {
+        std::stable_sort(v.begin(), v.end(), by_id);
+        return v.size();
+    });
+}
+
+TEST_CASE("bench_pipe_morsels()", "[benchmark]") {
+    namespace pipes = mleivo::pipes;
+    // a normalization pass: center, scale and clamp, as separate element-wise stages, with and without a sort after
+    const auto n = GENERATE(std::size_t{100'000}, std::size_t{2'000'000});
+    auto rng = std::mt19937_64{42};
+    auto dist = std::normal_distribution<double>{10.0, 4.0};
+    auto values = std::vector<double>(n);
+    for (auto& d : values)
+        d = dist(rng);
+    const auto make = [&values] { return values; };
+    const auto center = [](double& d) { d -= 10.0; };
+    const auto scale = [](double& d) { d *= 0.25; };
+    const auto below = [](double d) { return d < -1.0; };
+    const auto above = [](double d) { return d > 1.0; };
+    const auto name = [n](const char* what) { return bench_name(what, "double", n); };
+
+    bench_fresh(name("pipe normalize"), make, [&](auto& v) {
+        v | pipes::for_each(center) | pipes::for_each(scale) | pipes::replace_if(below, -1.0)
+            | pipes::replace_if(above, 1.0);
+        return v.size();
+    });
+    bench_fresh(name("pipe normalize morsels"), make, [&](auto& v) {
+        v | pipes::morsels | pipes::for_each(center) | pipes::for_each(scale) | pipes::replace_if(below, -1.0)
+            | pipes::replace_if(above, 1.0) | pipes::run();
+        return v.size();
+    });
+    bench_fresh(name("pipe normalize sort"), make, [&](auto& v) {
+        v | pipes::for_each(center) | pipes::for_each(scale) | pipes::replace_if(below, -1.0)
+            | pipes::replace_if(above, 1.0) | pipes::sort();
+        return v.size();
+    });
+    bench_fresh(name("pipe normalize sort morsels"), make, [&](auto& v) {
+        v | pipes::morsels | pipes::for_each(center) | pipes::for_each(scale) | pipes::replace_if(below, -1.0)
+            | pipes::replace_if(above, 1.0) | pipes::sort();
+        return v.size();
+    });
+}
+
+TEST_CASE("bench_pipe_pipeline()", "[benchmark]") {
+    namespace pipes = mleivo::pipes;
+    // a streaming consumer: many small batches remapped through a table the callable holds, sorted and summed
+    const auto batch_size = GENERATE(std::size_t{16}, std::size_t{256});
+    auto batches = std::vector<std::vector<int>>(10'000);
+    for (auto& batch : batches)
+        batch = random_ints(batch_size, 1024);
+    auto table = std::vector<int>(1024);
+    std::iota(table.begin(), table.end(), 0);
+    const auto remap = [table](int& i) { i = table[static_cast<std::size_t>(i) & 1023]; };
+    const auto name = [batch_size](const char* what) { return bench_name(what, "int", batch_size); };
+
+    BENCHMARK(name("pipe rebuilt per batch").c_str()) {
+        auto sum = std::int64_t{0};
+        for (auto& batch : batches)
+            sum += batch | pipes::for_each(remap) | pipes::sort() | pipes::accumulate(std::int64_t{0});
+        return sum;
+    };
+    const auto pipeline = pipes::for_each(remap) | pipes::sort() | pipes::accumulate(std::int64_t{0});
+    BENCHMARK(name("pipe pipeline").c_str()) {
+        auto sum = std::int64_t{0};
+        for (auto& batch : batches)
+            sum += batch | pipeline;
+        return sum;
+    };
+    BENCHMARK(name("std").c_str()) {
+        auto sum = std::int64_t{0};
+        for (auto& batch : batches) {
+            std::for_each(batch.begin(), batch.end(), remap);
+            std::sort(batch.begin(), batch.end());
+            sum += std::accumulate(batch.begin(), batch.end(), std::int64_t{0});
+        }
+        return sum;
+    };
+}
+
+TEST_CASE("bench_pipe_sum()", "[benchmark]") {
+    namespace pipes = mleivo::pipes;
+    const auto n = GENERATE(std::size_t{100'000}, std::size_t{10'000'000});
+    auto rng = std::mt19937_64{42};
+    auto dist = std::uniform_real_distribution<double>(-1.0, 1.0);
+    auto values = std::vector<double>(n);
+    for (auto& d : values)
+        d = dist(rng);
+    const auto name = [n](const char* what) { return bench_name(what, "double", n); };
+
+    BENCHMARK(name("pipe sum").c_str()) {
+        return values | pipes::sum();
+    };
+    BENCHMARK(name("pipe sum pairwise").c_str()) {
+        return values | pipes::sum(pipes::summation::pairwise);
+    };
+    BENCHMARK(name("pipe sum neumaier").c_str()) {
+        return values | pipes::sum(pipes::summation::neumaier);
+    };
+    BENCHMARK(name("pipe sum par").c_str()) {
+        return values | pipes::par | pipes::sum();
+    };
+    BENCHMARK(name("pipe sum neumaier par").c_str()) {
+        return values | pipes::par | pipes::sum(pipes::summation::neumaier);
+    };
+    BENCHMARK(name("pipe accumulate").c_str()) {
+        return values | pipes::accumulate(0.0);
+    };
+    BENCHMARK(name("std accumulate").c_str()) {
+        return std::accumulate(values.begin(), values.end(), 0.0);
+    };
+}
@@ -16,29 +16,192 @@
  */
 #pragma once
 
+#include "flat_map.h"
+#include "ring_buffer.h"
+#include "simd.h"
+#include "small_vector.h"
+#include "span.h"
+#include "static_map.h"
+#include "thread_pool.h"
 #include "type_traits.h"
 
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace mleivo::cu {
 using ::mleivo::type_traits::value_type;
 
+// static_cast_all(container, saturate) clamps arithmetic values to the range of the target type instead
+struct saturate_t {
+    explicit constexpr saturate_t() = default;
+};
+inline constexpr saturate_t saturate{};
+
 namespace detail {
 struct empty_struct {};
 
-template <typename To, typename From>
-auto static_cast_all_default_imp(const From& from) {
+template <typename ContainerT, typename = void>
+struct is_contiguous : std::false_type {};
+
+template <typename ContainerT>
+struct is_contiguous<ContainerT, std::void_t<decltype(std::data(std::declval<ContainerT&>())),
+                                            decltype(std::size(std::declval<ContainerT&>()))>>
+    : std::is_pointer<decltype(std::data(std::declval<ContainerT&>()))> {};
+
+// contiguous storage of a type the simd kernels compare, searched for a value of that very type
+template <typename ContainerT, typename ValueT, typename = void>
+struct is_simd_searchable : std::false_type {};
+
+template <typename ContainerT, typename ValueT>
+struct is_simd_searchable<ContainerT, ValueT, std::void_t<value_type<ContainerT>>>
+    : std::bool_constant<is_contiguous<const std::remove_reference_t<ContainerT>>::value
+                         && mleivo::simd::is_simd_comparable_v<value_type<ContainerT>>
+                         && std::is_same_v<value_type<ContainerT>, std::decay_t<ValueT>>> {};
+
+template <typename ContainerT, typename ValueT>
+inline constexpr bool is_simd_searchable_v = is_simd_searchable<ContainerT, ValueT>::value;
+
+// the allocator of T an allocator overload uses, a memory_resource* stands for a std::pmr::polymorphic_allocator
+template <typename T, typename AllocT>
+auto rebind_alloc(const AllocT& alloc) {
+    if constexpr (std::is_convertible_v<AllocT, std::pmr::memory_resource*>)
+        return std::pmr::polymorphic_allocator<T>(alloc);
+    else
+        return typename std::allocator_traits<AllocT>::template rebind_alloc<T>(alloc);
+}
+
+template <typename T, typename AllocT>
+using vector_for = std::vector<T, decltype(rebind_alloc<T>(std::declval<const AllocT&>()))>;
+
+template <typename T, typename AllocT>
+vector_for<T, AllocT> make_vector(const AllocT& alloc) {
+    return vector_for<T, AllocT>(rebind_alloc<T>(alloc));
+}
+
+// the output of the *_into functions: a container is appended to, anything else is an output iterator
+template <typename OutT>
+inline constexpr bool is_sink_container_v = mleivo::type_traits::has_method_push_back_v<OutT>;
+
+// room for n more elements, at least doubling the capacity so that appending in a loop stays amortized O(1)
+template <typename OutT>
+void reserve_more(OutT& out, std::size_t n) {
+    if constexpr (mleivo::type_traits::has_method_reserve_v<OutT> && mleivo::type_traits::has_method_capacity_v<OutT>) {
+        const auto needed = out.size() + n;
+        if (needed > out.capacity())
+            out.reserve(std::max(needed, 2 * out.capacity()));
+    }
+}
+
+// outputs that start with inline room, where reserving for a guessed upper bound would allocate for results that fit
+template <typename OutT>
+struct has_inline_storage : std::false_type {};
+
+template <typename T, std::size_t N, bool Growable>
+struct has_inline_storage<small_vector<T, N, Growable>> : std::true_type {};
+
+template <typename ContainerT>
+struct is_flat_container : std::false_type {};
+
+template <typename Key, typename Compare>
+struct is_flat_container<flat_set<Key, Compare>> : std::true_type {};
+
+template <typename Key, typename T, typename Compare>
+struct is_flat_container<flat_map<Key, T, Compare>> : std::true_type {};
+
+// tag selecting plain static_cast in static_cast_all
+struct static_cast_t {};
+
+template <bool Saturate, typename To, typename From>
+To cast_one(const From& from) {
+    if constexpr (Saturate && std::is_arithmetic_v<To> && std::is_arithmetic_v<From>)
+        return mleivo::simd::saturate_cast<To>(from);
+    else
+        return static_cast<To>(from);
+}
+
+// converts into an output that already has the input's size
+template <bool Saturate, typename From, typename To>
+void convert_into(const From& from, To&& out) {
     using std::cbegin;
     using std::cend;
-    To out;
-    std::transform(cbegin(from), cend(from), std::back_inserter(out),
-                   [](auto& e) { return static_cast<value_type<To>>(e); });
+    using std::begin;
+    using std::data;
+    using std::size;
+    using FromValueT = std::remove_cv_t<std::remove_reference_t<decltype(*cbegin(from))>>;
+    using ToValueT = std::remove_reference_t<decltype(*begin(out))>;
+    if constexpr (is_contiguous<const From>::value && is_contiguous<std::remove_reference_t<To>>::value
+                  && std::is_arithmetic_v<FromValueT> && std::is_arithmetic_v<ToValueT>) {
+        mleivo::simd::convert<Saturate>(data(from), data(out), size(from));
+    } else {
+        std::transform(cbegin(from), cend(from), begin(out),
+                       [](const auto& e) { return cast_one<Saturate, ToValueT>(e); });
+    }
+}
+
+// appends the converted values of from to out
+template <bool Saturate, typename To, typename From>
+void convert_append(To& out, const From& from) {
+    using std::cbegin;
+    using std::cend;
+    using std::data;
+    using std::size;
+    if constexpr (is_contiguous<To>::value && mleivo::type_traits::has_method_resize_v<To>) {
+        const auto old_size = size(out);
+        reserve_more(out, size(from));
+        out.resize(old_size + size(from));
+        convert_into<Saturate>(from, mleivo::cu::span<value_type<To>>(data(out) + old_size, size(from)));
+    } else {
+        if constexpr (mleivo::type_traits::has_method_size_v<From>)
+            reserve_more(out, from.size());
+        std::transform(cbegin(from), cend(from), std::back_inserter(out),
+                       [](auto& e) { return cast_one<Saturate, value_type<To>>(e); });
+    }
+}
+
+// writes the converted values of from through out, a pointer taking the simd path
+template <bool Saturate, typename T, typename OutIt, typename From>
+OutIt convert_to(OutIt out, const From& from) {
+    using std::cbegin;
+    using std::cend;
+    using std::data;
+    using std::size;
+    using FromValueT = std::remove_cv_t<std::remove_reference_t<decltype(*cbegin(from))>>;
+    if constexpr (std::is_same_v<OutIt, T*> && is_contiguous<const From>::value && std::is_arithmetic_v<FromValueT>
+                  && std::is_arithmetic_v<T>) {
+        mleivo::simd::convert<Saturate>(data(from), out, size(from));
+        return out + size(from);
+    } else {
+        return std::transform(cbegin(from), cend(from), out, [](const auto& e) { return cast_one<Saturate, T>(e); });
+    }
+}
+
+template <typename To, bool Saturate, typename From>
+auto static_cast_all_default_imp(const From& from, To out = To()) {
+    convert_append<Saturate>(out, from);
     return out;
 }
 
+template <typename ModeT>
+constexpr bool is_saturating() {
+    static_assert(std::is_same_v<ModeT, static_cast_t> || std::is_same_v<ModeT, saturate_t>);
+    return std::is_same_v<ModeT, saturate_t>;
+}
+
 template <typename It, typename SizeT>
 struct iter_value_type {
     static_assert(std::is_integral_v<SizeT>);
@@ -46,23 +209,40 @@ struct iter_value_type {
     It m_iter;
 };
 
+// operator* hands out the value stashed inside the iterator, so equal copies do not refer to the same object and the
+// iterator is an input iterator whatever It is. for_each_enumerated runs the same loop in parallel. Equal positions
+// have equal indices, so only the index is compared, and a narrow SizeT keeps that comparison cheap
 template <typename It, typename SizeT>
 struct iter {
+    using iterator_category = std::input_iterator_tag;
+    using value_type = iter_value_type<It, SizeT>;
+    using difference_type = typename std::iterator_traits<It>::difference_type;
+    using pointer = value_type*;
+    using reference = value_type&;
+
     auto& operator++() {
         ++m_value.m_index;
         ++m_value.m_iter;
         return *this;
     }
+    auto operator++(int) {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
 
-    auto& operator*() {
+    auto& operator*() const {
         return m_value;
     }
 
-    bool operator!=(const iter& rhs) {
-        return m_value.m_iter != rhs.m_value.m_iter || m_value.m_index != rhs.m_value.m_index;
+    friend bool operator==(const iter& lhs, const iter& rhs) {
+        return lhs.m_value.m_index == rhs.m_value.m_index;
+    }
+    friend bool operator!=(const iter& lhs, const iter& rhs) {
+        return lhs.m_value.m_index != rhs.m_value.m_index;
     }
 
-    iter_value_type<It, SizeT> m_value;
+    mutable iter_value_type<It, SizeT> m_value;
 };
 
 template <typename ContainerT, typename It, typename SizeT>
@@ -77,7 +257,7 @@ struct enumerate_struct
         : std::remove_reference_t<ContainerT>(std::move(container)),
           m_begin(std::begin(static_cast<std::remove_reference_t<ContainerT>&>(*this))),
           m_end(std::end(static_cast<std::remove_reference_t<ContainerT>&>(*this))),
-          m_size(std::size(static_cast<std::remove_reference_t<ContainerT>&>(*this))) {
+          m_size(static_cast<SizeT>(std::size(static_cast<std::remove_reference_t<ContainerT>&>(*this)))) {
     }
 
     auto begin() {
@@ -116,6 +296,14 @@ const auto& get(const iter_value_type<It, SizeT>& it) {
         return *it.m_iter;
 }
 
+template <bool Move, typename It>
+constexpr auto move_iterator_if(It it) {
+    if constexpr (Move)
+        return std::make_move_iterator(it);
+    else
+        return it;
+}
+
 template<typename T>
 constexpr auto begin_(T&& container)
 {
@@ -158,20 +346,44 @@ struct Enumerate
 template<typename ContainerT>
 Enumerate(ContainerT&&) -> Enumerate<ContainerT&&>;
 
-template <typename ContainerT>
+// enumerate<IndexT>(v) counts in IndexT instead of the container's size type
+template <typename IndexT = void, typename ContainerT>
 auto enumerate(ContainerT&& v) {
     using std::begin;
     using std::end;
     using std::size;
     using IterType = std::remove_reference_t<std::remove_cv_t<decltype(begin(v))>>;
-    using SizeType = decltype(size(std::declval<std::remove_cv_t<std::remove_reference_t<ContainerT>>>()));
+    using DefaultSizeType = decltype(size(std::declval<std::remove_cv_t<std::remove_reference_t<ContainerT>>>()));
+    using SizeType = std::conditional_t<std::is_void_v<IndexT>, DefaultSizeType, IndexT>;
+    assert(static_cast<std::uintmax_t>(size(v)) <= static_cast<std::uintmax_t>(std::numeric_limits<SizeType>::max()));
     if constexpr (std::is_rvalue_reference_v<decltype(v)>) {
         return detail::enumerate_struct<ContainerT&&, IterType, SizeType>(std::move(v));
     } else {
-        return detail::enumerate_struct<decltype(v), IterType, SizeType>{begin(v), end(v), size(v)};
+        return detail::enumerate_struct<decltype(v), IterType, SizeType>{begin(v), end(v),
+                                                                         static_cast<SizeType>(size(v))};
     }
 }
 
+// for_each_enumerated(c, f) calls f(i, e) for every element e of the random access container c and its index i, on
+// exec::thread_pool::global(): the parallel `for (auto&& [i, e] : enumerate(c))`. Each thread gets a run of indices
+// of at least grain, counted in IndexT as with enumerate<IndexT>
+template <typename IndexT = void, typename ContainerT, typename F>
+void for_each_enumerated(ContainerT&& c, F&& f, std::size_t grain = 1024) {
+    using std::begin;
+    using std::size;
+    using It = decltype(begin(c));
+    static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category>,
+                  "for_each_enumerated splits the container by index");
+    using SizeType = std::conditional_t<std::is_void_v<IndexT>, decltype(size(c)), IndexT>;
+    const auto n = static_cast<std::size_t>(size(c));
+    assert(n <= static_cast<std::uintmax_t>(std::numeric_limits<SizeType>::max()));
+    auto& pool = exec::thread_pool::global();
+    const auto first = begin(c);
+    exec::parallel_for(
+        pool, 0, n, [&](std::size_t i) { f(static_cast<SizeType>(i), first[static_cast<std::ptrdiff_t>(i)]); },
+        std::max(grain, n / (8 * pool.size())));
+}
+
 template <typename ContainerT>
 std::vector<value_type<ContainerT>> to_std_vector(ContainerT&& c);
 
@@ -192,83 +404,424 @@ bool any_of(const ContainerT& container, UnaryPredicate&& predicate) {
 }
 
 // static_cast_all
-template <typename T, typename ValueT, template <typename...> typename ContainerT, typename... ContainerTArgs>
-auto static_cast_all(const ContainerT<ValueT, ContainerTArgs...>& container) {
-    return detail::static_cast_all_default_imp<ContainerT<T>>(container);
+template <typename T, typename ValueT, template <typename...> typename ContainerT, typename... ContainerTArgs,
+          typename ModeT = detail::static_cast_t>
+auto static_cast_all(const ContainerT<ValueT, ContainerTArgs...>& container, ModeT = {}) {
+    return detail::static_cast_all_default_imp<ContainerT<T>, detail::is_saturating<ModeT>()>(container);
 }
 
-template <typename OutT, typename InT, size_t N>
-auto static_cast_all(const InT (&container)[N]) {
-    using std::back_inserter;
-    using std::begin;
-    using std::end;
+template <typename OutT, typename InT, size_t N, typename ModeT = detail::static_cast_t>
+auto static_cast_all(const InT (&container)[N], ModeT = {}) {
     auto out = std::array<OutT, N>();
-    std::copy(begin(container), end(container), begin(out));
+    detail::convert_into<detail::is_saturating<ModeT>()>(container, out);
     return out;
 }
 
-template <typename T, typename FromT, size_t N, template <typename, size_t> typename ContainerT>
-auto static_cast_all(const ContainerT<FromT, N>& container) {
-    using std::back_inserter;
-    using std::begin;
-    using std::end;
+template <typename T, typename FromT, size_t N, template <typename, size_t> typename ContainerT,
+          typename ModeT = detail::static_cast_t>
+auto static_cast_all(const ContainerT<FromT, N>& container, ModeT = {}) {
     auto out = ContainerT<T, N>();
-    std::copy(begin(container), end(container), begin(out));
+    detail::convert_into<detail::is_saturating<ModeT>()>(container, out);
     return out;
 }
 
-template <typename T, typename ContainerT> // fall back to returning an std::vector
-auto static_cast_all(const ContainerT& container) {
-    return detail::static_cast_all_default_imp<std::vector<T>>(container);
+template <typename T, typename ContainerT, typename ModeT = detail::static_cast_t> // fall back to an std::vector
+auto static_cast_all(const ContainerT& container, ModeT = {}) {
+    return detail::static_cast_all_default_imp<std::vector<T>, detail::is_saturating<ModeT>()>(container);
+}
+
+// into a std::vector using alloc, or a std::pmr::vector for a std::pmr::memory_resource*
+template <typename T, typename AllocT, typename ContainerT, typename ModeT = detail::static_cast_t>
+auto static_cast_all(std::allocator_arg_t, const AllocT& alloc, const ContainerT& container, ModeT = {}) {
+    return detail::static_cast_all_default_imp<detail::vector_for<T, AllocT>, detail::is_saturating<ModeT>()>(
+        container, detail::make_vector<T>(alloc));
+}
+
+// static_cast_all_into(out, container) appends the converted values to the container out, reusing its capacity, or
+// writes them through the output iterator out and returns the iterator past the last one. static_cast_all_into<T>
+// names the target type for iterators such as std::back_insert_iterator that do not tell it
+template <typename T = void, typename OutT, typename ContainerT, typename ModeT = detail::static_cast_t>
+decltype(auto) static_cast_all_into(OutT&& out, const ContainerT& container, ModeT = {}) {
+    constexpr auto saturate = detail::is_saturating<ModeT>();
+    if constexpr (detail::is_sink_container_v<OutT>) {
+        static_assert(std::is_lvalue_reference_v<OutT>, "the output container has to outlive the call");
+        static_assert(std::is_void_v<T> || std::is_same_v<T, value_type<OutT>>);
+        detail::convert_append<saturate>(out, container);
+        return (out);
+    } else {
+        using target_t =
+            std::conditional_t<std::is_void_v<T>, typename std::iterator_traits<std::decay_t<OutT>>::value_type, T>;
+        static_assert(!std::is_void_v<target_t>, "static_cast_all_into<T> needs the target type for this iterator");
+        return detail::convert_to<saturate, target_t>(std::decay_t<OutT>(out), container);
+    }
 }
 
 // contains
+namespace detail {
+template <typename ContainerT, typename ValueT>
+using contains_result_t = decltype(std::declval<const ContainerT&>().contains(std::declval<const ValueT&>()));
+
+template <typename ContainerT, typename ValueT>
+using count_result_t = decltype(std::declval<const ContainerT&>().count(std::declval<const ValueT&>()));
+
+template <typename ContainerT, typename ValueT, typename = void>
+struct has_contains_for : std::false_type {};
+
+template <typename ContainerT, typename ValueT>
+struct has_contains_for<ContainerT, ValueT, std::void_t<contains_result_t<ContainerT, ValueT>>> : std::true_type {};
+
+template <typename ContainerT, typename ValueT, typename = void>
+struct has_count_for : std::false_type {};
+
+template <typename ContainerT, typename ValueT>
+struct has_count_for<ContainerT, ValueT, std::void_t<count_result_t<ContainerT, ValueT>>> : std::true_type {};
+} // namespace detail
+
+// sorted and hashed containers, such as flat_set and flat_map, look the value up with their own contains or count
 template <typename ContainerT, typename ValueT>
 bool contains(const ContainerT& c, const ValueT& value) {
-    if constexpr (mleivo::type_traits::has_method_contains_v<ContainerT>) {
+    if constexpr (detail::has_contains_for<ContainerT, ValueT>::value) {
         return c.contains(value);
-    } else if constexpr (mleivo::type_traits::has_method_count_v<ContainerT>) {
+    } else if constexpr (detail::has_count_for<ContainerT, ValueT>::value) {
         return c.count(value) != 0;
+    } else if constexpr (detail::is_simd_searchable_v<ContainerT, ValueT>) {
+        using std::data;
+        using std::size;
+        return mleivo::simd::find(data(c), data(c) + size(c), value) != data(c) + size(c);
     } else {
         return std::find(std::begin(c), std::end(c), value) != std::end(c);
     }
 }
 
 // filter
-template <typename ContainerT, typename Filter>
-std::vector<value_type<ContainerT>> filter(ContainerT&& c, Filter&& f) {
-    std::vector<value_type<decltype(c)>> v;
-    if constexpr (std::is_rvalue_reference_v<decltype(c)> && std::is_move_constructible_v<value_type<decltype(c)>>) {
-        std::copy_if(std::make_move_iterator(std::begin(c)), std::make_move_iterator(std::end(c)),
-                     std::back_inserter(v), std::forward<Filter>(f));
+// reserves for every element to pass, so the output allocates once, unless a small_vector may hold the result inline.
+// the predicate sees each element as a const lvalue and only the elements it keeps are moved out of an rvalue container
+namespace detail {
+template <typename OutIt, typename ContainerT, typename Filter>
+OutIt filter_to(OutIt out, ContainerT&& c, Filter& f) {
+    constexpr auto move = std::is_rvalue_reference_v<decltype(c)>
+                          && !std::is_const_v<std::remove_reference_t<ContainerT>>
+                          && std::is_move_constructible_v<value_type<decltype(c)>>;
+    for (auto&& e : c) {
+        if (f(std::as_const(e))) {
+            if constexpr (move)
+                *out = std::move(e);
+            else
+                *out = e;
+            ++out;
+        }
+    }
+    return out;
+}
+
+template <typename OutT, typename ContainerT, typename Filter>
+void filter(OutT& out, ContainerT&& c, Filter& f) {
+    if constexpr (mleivo::type_traits::has_method_size_v<ContainerT> && !has_inline_storage<OutT>::value)
+        reserve_more(out, c.size());
+    filter_to(std::back_inserter(out), std::forward<ContainerT>(c), f);
+}
+} // namespace detail
+
+// filter<OutT>(c, f) returns an OutT, such as a small_vector, instead of a std::vector
+template <typename OutT = void, typename ContainerT, typename Filter>
+auto filter(ContainerT&& c, Filter&& f) {
+    auto out = std::conditional_t<std::is_void_v<OutT>, std::vector<value_type<ContainerT>>, OutT>{};
+    detail::filter(out, std::forward<ContainerT>(c), f);
+    return out;
+}
+
+// into a std::vector using alloc, or a std::pmr::vector for a std::pmr::memory_resource*
+template <typename AllocT, typename ContainerT, typename Filter>
+auto filter(std::allocator_arg_t, const AllocT& alloc, ContainerT&& c, Filter&& f) {
+    auto out = detail::make_vector<value_type<ContainerT>>(alloc);
+    detail::filter(out, std::forward<ContainerT>(c), f);
+    return out;
+}
+
+// filter_into(out, c, f) appends the kept elements to the container out, reusing its capacity, or writes them through
+// the output iterator out and returns the iterator past the last one
+template <typename OutT, typename ContainerT, typename Filter>
+decltype(auto) filter_into(OutT&& out, ContainerT&& c, Filter&& f) {
+    if constexpr (detail::is_sink_container_v<OutT>) {
+        static_assert(std::is_lvalue_reference_v<OutT>, "the output container has to outlive the call");
+        detail::filter(out, std::forward<ContainerT>(c), f);
+        return (out);
     } else {
-        std::copy_if(std::begin(c), std::end(c), std::back_inserter(v), std::forward<Filter>(f));
+        return detail::filter_to(std::decay_t<OutT>(out), std::forward<ContainerT>(c), f);
     }
-    return v;
 }
 
 // merge
-template <typename ContainerT>
-std::vector<value_type<ContainerT>> merge(ContainerT&& c) {
-    return to_std_vector(std::forward<ContainerT>(c));
+namespace detail {
+// appends c to out, moving from an rvalue and copying trivially copyable contiguous storage in one block. a flat_set
+// or flat_map output takes c as one sorted batch
+template <typename OutT, typename ContainerT>
+void append(OutT& out, ContainerT&& c) {
+    using std::begin;
+    using std::data;
+    using std::end;
+    using std::size;
+    using in_t = value_type<ContainerT>;
+    if constexpr (is_flat_container<OutT>::value) {
+        constexpr auto move =
+            std::is_rvalue_reference_v<decltype(c)> && !std::is_const_v<std::remove_reference_t<ContainerT>>;
+        if constexpr (std::is_same_v<OutT, std::decay_t<ContainerT>>)
+            out.merge(c);
+        else
+            out.insert(move_iterator_if<move>(begin(c)), move_iterator_if<move>(end(c)));
+    } else if constexpr (!std::is_move_constructible_v<in_t> || !std::is_move_assignable_v<in_t>) {
+        std::copy(begin(c), end(c), std::back_inserter(out));
+    } else if constexpr (is_contiguous<OutT>::value && is_contiguous<const std::remove_reference_t<ContainerT>>::value
+                         && std::is_trivially_copyable_v<in_t>) {
+        out.insert(out.end(), data(c), data(c) + size(c));
+    } else {
+        constexpr auto move =
+            std::is_rvalue_reference_v<decltype(c)> && !std::is_const_v<std::remove_reference_t<ContainerT>>;
+        if constexpr (is_contiguous<OutT>::value)
+            out.insert(out.end(), move_iterator_if<move>(begin(c)), move_iterator_if<move>(end(c)));
+        else
+            std::copy(move_iterator_if<move>(begin(c)), move_iterator_if<move>(end(c)), std::back_inserter(out));
+    }
 }
 
-template <typename ContainerT1, typename... ContainerT2ToN>
-std::enable_if_t<mleivo::type_traits::value_types_equal_v<ContainerT1, ContainerT2ToN...>,
-                 std::vector<value_type<ContainerT1>>>
-merge(ContainerT1&& c1, ContainerT2ToN&&... c2ToN) {
-    auto out = merge(std::forward<ContainerT1>(c1));
-    auto mergedTail = merge(std::forward<ContainerT2ToN>(c2ToN)...);
-    if constexpr (std::is_move_constructible_v<value_type<decltype(mergedTail)>>) {
-        out.insert(out.end(), std::make_move_iterator(std::begin(mergedTail)),
-                   std::make_move_iterator(std::end(mergedTail)));
+// copies c through out, moving from an rvalue
+template <typename OutIt, typename ContainerT>
+OutIt copy_to(OutIt out, ContainerT&& c) {
+    using std::begin;
+    using std::end;
+    using in_t = value_type<ContainerT>;
+    constexpr auto move = std::is_rvalue_reference_v<decltype(c)>
+                          && !std::is_const_v<std::remove_reference_t<ContainerT>>
+                          && std::is_move_constructible_v<in_t> && std::is_move_assignable_v<in_t>;
+    return std::copy(move_iterator_if<move>(begin(c)), move_iterator_if<move>(end(c)), out);
+}
+
+// tournament of k sorted sources where each inner node keeps the loser of its match and m_tree[0] the overall winner,
+// so taking the next element replays only the log2(k) matches on the winner's path
+template <typename It, typename Compare>
+class loser_tree {
+public:
+    loser_tree(std::vector<std::pair<It, It>> sources, Compare cmp)
+        : m_sources(std::move(sources)), m_tree(std::max<std::size_t>(m_sources.size(), 1)), m_cmp(std::move(cmp)) {
+        if (!m_sources.empty())
+            m_tree[0] = build(1);
+    }
+
+    bool empty() const {
+        return m_sources.empty() || exhausted(m_tree[0]);
+    }
+
+    It& top() {
+        return m_sources[m_tree[0]].first;
+    }
+
+    void pop() {
+        auto winner = m_tree[0];
+        ++m_sources[winner].first;
+        for (auto node = (winner + m_sources.size()) / 2; node > 0; node /= 2) {
+            if (beats(m_tree[node], winner))
+                std::swap(m_tree[node], winner);
+        }
+        m_tree[0] = winner;
+    }
+
+private:
+    bool exhausted(std::size_t source) const {
+        return m_sources[source].first == m_sources[source].second;
+    }
+
+    // equal elements leave in source order, which keeps the merge stable
+    bool beats(std::size_t a, std::size_t b) {
+        if (exhausted(a) || exhausted(b))
+            return !exhausted(a);
+        if (m_cmp(*m_sources[a].first, *m_sources[b].first))
+            return true;
+        if (m_cmp(*m_sources[b].first, *m_sources[a].first))
+            return false;
+        return a < b;
+    }
+
+    // the leaves are nodes k..2k-1, returns the winner of the subtree at node
+    std::size_t build(std::size_t node) {
+        if (node >= m_sources.size())
+            return node - m_sources.size();
+        auto lhs = build(2 * node);
+        auto rhs = build(2 * node + 1);
+        if (beats(rhs, lhs))
+            std::swap(lhs, rhs);
+        m_tree[node] = rhs;
+        return lhs;
+    }
+
+    std::vector<std::pair<It, It>> m_sources;
+    std::vector<std::size_t> m_tree;
+    Compare m_cmp;
+};
+
+template <typename T, typename It, typename Compare>
+std::vector<T> merge_sorted(std::vector<std::pair<It, It>> sources, Compare cmp) {
+    auto total = std::size_t{0};
+    for (const auto& [first, last] : sources)
+        total += static_cast<std::size_t>(std::distance(first, last));
+    std::vector<T> out;
+    out.reserve(total);
+    auto tree = loser_tree<It, Compare>(std::move(sources), std::move(cmp));
+    for (; !tree.empty(); tree.pop())
+        out.push_back(*tree.top());
+    return out;
+}
+
+template <typename T>
+inline constexpr bool is_movable_source_v =
+    std::is_rvalue_reference_v<T> && !std::is_const_v<std::remove_reference_t<T>>;
+
+// whether the containers I of the arguments ArgsT are of one type, and all non-const rvalues to move from
+struct merge_sorted_traits {
+    bool same_type;
+    bool movable;
+};
+
+template <typename ArgsT, std::size_t... I>
+constexpr merge_sorted_traits merge_sorted_sources(std::index_sequence<I...>) {
+    using first_t = std::decay_t<std::tuple_element_t<0, ArgsT>>;
+    return {(std::is_same_v<std::decay_t<std::tuple_element_t<I, ArgsT>>, first_t> && ...),
+            (is_movable_source_v<std::tuple_element_t<I, ArgsT>> && ...)};
+}
+
+// the ranges of the containers I of args, moved from when Move
+template <bool Move, typename ArgsT, std::size_t... I>
+auto sorted_sources(ArgsT& args, std::index_sequence<I...>) {
+    using std::begin;
+    using std::end;
+    using container_t = std::decay_t<std::tuple_element_t<0, ArgsT>>;
+    using source_t = std::conditional_t<Move, container_t&, const container_t&>;
+    using it_t = decltype(move_iterator_if<Move>(begin(std::declval<source_t>())));
+    auto sources = std::vector<std::pair<it_t, it_t>>{};
+    sources.reserve(sizeof...(I));
+    (sources.emplace_back(move_iterator_if<Move>(begin(static_cast<source_t>(std::get<I>(args)))),
+                          move_iterator_if<Move>(end(static_cast<source_t>(std::get<I>(args))))),
+     ...);
+    return sources;
+}
+
+template <typename OutT, typename ContainerT1, typename... ContainerT2ToN>
+void merge(OutT& out, ContainerT1&& c1, ContainerT2ToN&&... c2ToN) {
+    if constexpr ((mleivo::type_traits::has_method_size_v<ContainerT1> && ...
+                   && mleivo::type_traits::has_method_size_v<ContainerT2ToN>))
+        reserve_more(out, (c1.size() + ... + c2ToN.size()));
+    append(out, std::forward<ContainerT1>(c1));
+    (append(out, std::forward<ContainerT2ToN>(c2ToN)), ...);
+}
+
+// OutT when given, the type of the inputs when they are flat_sets or flat_maps of one type and a std::vector otherwise
+template <typename OutT, typename ContainerT1, typename... ContainerT2ToN>
+constexpr bool merges_flat_containers_v =
+    std::is_void_v<OutT> && is_flat_container<std::decay_t<ContainerT1>>::value
+    && std::conjunction_v<std::is_same<std::decay_t<ContainerT1>, std::decay_t<ContainerT2ToN>>...>;
+
+template <typename OutT, typename ContainerT1, typename... ContainerT2ToN>
+using merge_result_t = std::conditional_t<
+    merges_flat_containers_v<OutT, ContainerT1, ContainerT2ToN...>, std::decay_t<ContainerT1>,
+    std::conditional_t<std::is_void_v<OutT>, std::vector<value_type<ContainerT1>>, OutT>>;
+} // namespace detail
+
+// merge<OutT>(c1, c2, ...) returns an OutT, such as a small_vector, instead of a std::vector. merging flat_sets or
+// flat_maps of one type gives their union, of that type
+template <typename OutT = void, typename ContainerT>
+auto merge(ContainerT&& c) {
+    using out_t = detail::merge_result_t<OutT, ContainerT>;
+    if constexpr (std::is_same_v<out_t, std::vector<value_type<ContainerT>>>) {
+        return to_std_vector(std::forward<ContainerT>(c));
     } else {
-        std::copy(std::begin(mergedTail), std::end(mergedTail), std::back_inserter(out));
+        auto out = out_t{};
+        detail::merge(out, std::forward<ContainerT>(c));
+        return out;
     }
+}
 
+// reserves the total size once and copies, or moves, every element once
+template <typename OutT = void, typename ContainerT1, typename... ContainerT2ToN>
+std::enable_if_t<std::conjunction_v<std::negation<std::is_same<std::decay_t<ContainerT1>, std::allocator_arg_t>>,
+                                    mleivo::type_traits::value_types_equal<ContainerT1, ContainerT2ToN...>>,
+                 detail::merge_result_t<OutT, ContainerT1, ContainerT2ToN...>>
+merge(ContainerT1&& c1, ContainerT2ToN&&... c2ToN) {
+    auto out = detail::merge_result_t<OutT, ContainerT1, ContainerT2ToN...>{};
+    detail::merge(out, std::forward<ContainerT1>(c1), std::forward<ContainerT2ToN>(c2ToN)...);
+    return out;
+}
+
+// into a std::vector using alloc, or a std::pmr::vector for a std::pmr::memory_resource*
+template <typename AllocT, typename ContainerT1, typename... ContainerT2ToN>
+std::enable_if_t<mleivo::type_traits::value_types_equal_v<ContainerT1, ContainerT2ToN...>,
+                 detail::vector_for<value_type<ContainerT1>, AllocT>>
+merge(std::allocator_arg_t, const AllocT& alloc, ContainerT1&& c1, ContainerT2ToN&&... c2ToN) {
+    auto out = detail::make_vector<value_type<ContainerT1>>(alloc);
+    detail::merge(out, std::forward<ContainerT1>(c1), std::forward<ContainerT2ToN>(c2ToN)...);
     return out;
 }
 
+// merge_into(out, c1, c2, ...) appends every element to the container out, reusing its capacity, or writes them
+// through the output iterator out and returns the iterator past the last one
+template <typename OutT, typename ContainerT1, typename... ContainerT2ToN>
+decltype(auto) merge_into(OutT&& out, ContainerT1&& c1, ContainerT2ToN&&... c2ToN) {
+    static_assert(mleivo::type_traits::value_types_equal_v<ContainerT1, ContainerT2ToN...>);
+    if constexpr (detail::is_sink_container_v<OutT>) {
+        static_assert(std::is_lvalue_reference_v<OutT>, "the output container has to outlive the call");
+        detail::merge(out, std::forward<ContainerT1>(c1), std::forward<ContainerT2ToN>(c2ToN)...);
+        return (out);
+    } else {
+        auto it = detail::copy_to(std::decay_t<OutT>(out), std::forward<ContainerT1>(c1));
+        ((it = detail::copy_to(it, std::forward<ContainerT2ToN>(c2ToN))), ...);
+        return it;
+    }
+}
+
+// merge_sorted
+// stable k-way merge of sorted containers, given as a container of them or as separate arguments of one type
+template <typename ContainersT, typename Compare = std::less<>,
+          typename = std::enable_if_t<!std::is_same_v<std::decay_t<ContainersT>, std::decay_t<Compare>>>,
+          typename = std::void_t<value_type<value_type<ContainersT>>>>
+auto merge_sorted(ContainersT&& containers, Compare cmp = {}) {
+    using std::begin;
+    using std::end;
+    using container_t = value_type<ContainersT>;
+    constexpr auto move = std::is_rvalue_reference_v<decltype(containers)>
+                          && !std::is_const_v<std::remove_reference_t<ContainersT>>
+                          && std::is_move_constructible_v<value_type<container_t>>;
+    using source_t = std::conditional_t<move, container_t&, const container_t&>;
+    using it_t = decltype(detail::move_iterator_if<move>(begin(std::declval<source_t>())));
+    auto sources = std::vector<std::pair<it_t, it_t>>{};
+    if constexpr (mleivo::type_traits::has_method_size_v<ContainersT>)
+        sources.reserve(containers.size());
+    for (source_t c : containers)
+        sources.emplace_back(detail::move_iterator_if<move>(begin(c)), detail::move_iterator_if<move>(end(c)));
+    return detail::merge_sorted<value_type<container_t>>(std::move(sources), std::move(cmp));
+}
+
+// as separate arguments, merge_sorted(c1, c2, ...) or merge_sorted(c1, c2, ..., cmp). The elements are moved when
+// every container is a non-const rvalue, and copied otherwise
+template <typename ContainerT1, typename ContainerT2, typename... ContainerT3ToNAndCompare>
+auto merge_sorted(ContainerT1&& c1, ContainerT2&& c2, ContainerT3ToNAndCompare&&... rest)
+    -> std::enable_if_t<std::is_same_v<std::decay_t<ContainerT1>, std::decay_t<ContainerT2>>,
+                        std::vector<value_type<ContainerT1>>> {
+    using args_t = std::tuple<ContainerT1&&, ContainerT2&&, ContainerT3ToNAndCompare&&...>;
+    constexpr auto n = std::tuple_size_v<args_t>;
+    constexpr auto has_cmp =
+        !std::is_same_v<std::decay_t<std::tuple_element_t<n - 1, args_t>>, std::decay_t<ContainerT1>>;
+    using indices = std::make_index_sequence<has_cmp ? n - 1 : n>;
+    static_assert(detail::merge_sorted_sources<args_t>(indices{}).same_type,
+                  "merge_sorted takes containers of one type");
+    constexpr auto move = detail::merge_sorted_sources<args_t>(indices{}).movable
+                          && std::is_move_constructible_v<value_type<ContainerT1>>;
+    auto args = args_t(std::forward<ContainerT1>(c1), std::forward<ContainerT2>(c2),
+                       std::forward<ContainerT3ToNAndCompare>(rest)...);
+    auto sources = detail::sorted_sources<move>(args, indices{});
+    if constexpr (has_cmp)
+        return detail::merge_sorted<value_type<ContainerT1>>(std::move(sources), std::get<n - 1>(args));
+    else
+        return detail::merge_sorted<value_type<ContainerT1>>(std::move(sources), std::less<>{});
+}
+
 // move_to_index
 template <typename ContainerT>
 void move_to_index(ContainerT& container, typename std::decay_t<ContainerT>::difference_type oldIndex,
@@ -288,7 +841,12 @@ template <typename ContainerT, typename T>
 auto index_of(const ContainerT& container, T&& predOrItem) {
     using std::cbegin;
     using std::cend;
-    if constexpr (std::is_same_v<value_type<ContainerT>, std::decay_t<T>>)
+    using std::data;
+    using std::size;
+    if constexpr (detail::is_simd_searchable_v<ContainerT, T>)
+        return std::distance(data(container), mleivo::simd::find(data(container), data(container) + size(container),
+                                                                 predOrItem));
+    else if constexpr (std::is_same_v<value_type<ContainerT>, std::decay_t<T>>)
         return std::distance(cbegin(container), std::find(cbegin(container), cend(container), predOrItem));
     else
         return std::distance(cbegin(container),
@@ -296,87 +854,289 @@ auto index_of(const ContainerT& container, T&& predOrItem) {
 }
 
 namespace { namespace irange_lazy_impl {
-template <typename T, bool IsUnsigned = std::is_unsigned_v<T>>
+// the values are computed from the index in unsigned arithmetic, so ranges spanning the whole of T do not overflow
+template <typename T>
 struct IRangeLazyIter {
-    T m_value;
-    const T m_step;
-    const T m_sign = m_step < T{} ? static_cast<T>(-1) : static_cast<T>(1);
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = T;
+    using unsigned_t = std::make_unsigned_t<T>;
 
-    void operator++() {
-        m_value += m_step;
-    };
-    auto operator*() const noexcept {
-        return m_value;
+    T m_first;
+    T m_step;
+    difference_type m_index;
+
+    T operator*() const noexcept {
+        return (*this)[0];
+    }
+    T operator[](difference_type n) const noexcept {
+        return static_cast<T>(static_cast<unsigned_t>(m_first)
+                              + static_cast<unsigned_t>(m_index + n) * static_cast<unsigned_t>(m_step));
     }
 
-    template <bool X = IsUnsigned>
-    bool operator!=(const IRangeLazyIter& rhs) const noexcept {
-        if constexpr (X) {
-            return *(*this) < *rhs;
-        } else {
-            return m_sign * *(*this) < m_sign * *rhs;
-        }
+    IRangeLazyIter& operator++() noexcept {
+        ++m_index;
+        return *this;
+    }
+    IRangeLazyIter operator++(int) noexcept {
+        auto tmp = *this;
+        ++m_index;
+        return tmp;
+    }
+    IRangeLazyIter& operator--() noexcept {
+        --m_index;
+        return *this;
+    }
+    IRangeLazyIter operator--(int) noexcept {
+        auto tmp = *this;
+        --m_index;
+        return tmp;
+    }
+    IRangeLazyIter& operator+=(difference_type n) noexcept {
+        m_index += n;
+        return *this;
+    }
+    IRangeLazyIter& operator-=(difference_type n) noexcept {
+        m_index -= n;
+        return *this;
+    }
+    friend IRangeLazyIter operator+(IRangeLazyIter it, difference_type n) noexcept {
+        return it += n;
+    }
+    friend IRangeLazyIter operator+(difference_type n, IRangeLazyIter it) noexcept {
+        return it += n;
+    }
+    friend IRangeLazyIter operator-(IRangeLazyIter it, difference_type n) noexcept {
+        return it -= n;
+    }
+    friend difference_type operator-(const IRangeLazyIter& lhs, const IRangeLazyIter& rhs) noexcept {
+        return lhs.m_index - rhs.m_index;
+    }
+
+    friend bool operator==(const IRangeLazyIter& lhs, const IRangeLazyIter& rhs) noexcept {
+        return lhs.m_index == rhs.m_index;
+    }
+    friend bool operator!=(const IRangeLazyIter& lhs, const IRangeLazyIter& rhs) noexcept {
+        return lhs.m_index != rhs.m_index;
+    }
+    friend bool operator<(const IRangeLazyIter& lhs, const IRangeLazyIter& rhs) noexcept {
+        return lhs.m_index < rhs.m_index;
+    }
+    friend bool operator>(const IRangeLazyIter& lhs, const IRangeLazyIter& rhs) noexcept {
+        return lhs.m_index > rhs.m_index;
+    }
+    friend bool operator<=(const IRangeLazyIter& lhs, const IRangeLazyIter& rhs) noexcept {
+        return lhs.m_index <= rhs.m_index;
+    }
+    friend bool operator>=(const IRangeLazyIter& lhs, const IRangeLazyIter& rhs) noexcept {
+        return lhs.m_index >= rhs.m_index;
     }
 };
 
 template <typename T>
 struct IRangeLazy {
-    const T m_a;
-    const T m_b;
-    const T m_step;
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = IRangeLazyIter<T>;
+    using const_iterator = iterator;
+
+    T m_first;
+    T m_step;
+    size_type m_size;
 
-    auto begin() const {
-        return IRangeLazyIter<T>{m_a, m_step};
+    auto begin() const noexcept {
+        return iterator{m_first, m_step, 0};
+    }
+    auto end() const noexcept {
+        return iterator{m_first, m_step, static_cast<typename iterator::difference_type>(m_size)};
     }
-    auto end() const {
-        return IRangeLazyIter<T>{m_b, m_step};
+    size_type size() const noexcept {
+        return m_size;
+    }
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+    T operator[](size_type i) const noexcept {
+        assert(i < m_size);
+        return begin()[static_cast<typename iterator::difference_type>(i)];
+    }
+
+    // the values at [from, to), e.g. one chunk of the index space for a worker
+    IRangeLazy slice(size_type from, size_type to) const noexcept {
+        assert(from <= to && to <= m_size);
+        return IRangeLazy{from == to ? m_first : (*this)[from], m_step, to - from};
     }
 };
+
+// number of values a, a + step, ... before reaching b
+template <typename T>
+std::size_t trip_count(T a, T b, T step) noexcept {
+    using unsigned_t = std::make_unsigned_t<T>;
+    assert(step != T{});
+    // explicit casts after each operation, small types are promoted to int
+    const auto distance = [](T from, T to) {
+        return static_cast<unsigned_t>(static_cast<unsigned_t>(to) - static_cast<unsigned_t>(from));
+    };
+    if (step > T{} && a < b)
+        return static_cast<std::size_t>(static_cast<unsigned_t>(distance(a, b) - 1u) / distance(T{}, step)) + 1;
+    if (step < T{} && b < a)
+        return static_cast<std::size_t>(static_cast<unsigned_t>(distance(b, a) - 1u) / distance(step, T{})) + 1;
+    return 0;
+}
 }} // namespace ::irange_lazy_impl
 
-template <typename I, typename = std::enable_if_t<std::is_integral_v<I>>>
+// irange: the values a, a + step, ... up to but excluding b, as a sized random access range
+template <typename I, typename = std::enable_if_t<std::is_integral_v<I> && !std::is_same_v<I, bool>>>
 auto irange(const I& a, const I& b, const I& step) {
-    return irange_lazy_impl::IRangeLazy<I>{a, b, step};
+    return irange_lazy_impl::IRangeLazy<I>{a, step, irange_lazy_impl::trip_count(a, b, step)};
 }
 
 // pop_front
+// O(1) for containers with their own pop_front, such as ring_buffer and std::deque
 template <typename ContainerT>
 void pop_front(ContainerT& v) {
     using std::begin;
     assert(!v.empty());
-    v.erase(begin(v));
+    if constexpr (mleivo::type_traits::has_method_pop_front_v<ContainerT>)
+        v.pop_front();
+    else
+        v.erase(begin(v));
 }
 
 // remove_all
+namespace detail {
+// the erase(key) of sorted and hashed containers
+template <typename ContainerT, typename KeyT, typename = void>
+struct has_erase_key : std::false_type {};
+
+template <typename ContainerT, typename KeyT>
+struct has_erase_key<ContainerT, KeyT,
+                     std::void_t<decltype(std::declval<ContainerT&>().erase(std::declval<const KeyT&>()))>>
+    : std::is_integral<decltype(std::declval<ContainerT&>().erase(std::declval<const KeyT&>()))> {};
+
+template <typename ContainerT, typename Pred, typename = void>
+struct has_erase_if : std::false_type {};
+
+template <typename ContainerT, typename Pred>
+struct has_erase_if<ContainerT, Pred, std::void_t<decltype(std::declval<ContainerT&>().erase_if(std::declval<Pred>()))>>
+    : std::true_type {};
+} // namespace detail
+
+// an item is looked up with the container's own erase(key) when it has one, such as flat_set, std::set and
+// std::unordered_map, and a predicate goes to its erase_if
 template <typename ContainerT, typename T>
 void remove_all(ContainerT& container, T&& predOrItem) {
     using std::begin;
     using std::end;
-    if constexpr (mleivo::type_traits::is_unary_predicate_v<decltype(predOrItem), value_type<ContainerT>>)
-        container.erase(std::remove_if(begin(container), end(container), std::forward<T>(predOrItem)), end(container));
-    else
+    if constexpr (mleivo::type_traits::is_unary_predicate_v<decltype(predOrItem), value_type<ContainerT>>) {
+        if constexpr (detail::has_erase_if<ContainerT, T>::value) {
+            container.erase_if(std::forward<T>(predOrItem));
+        } else if constexpr (detail::has_erase_key<ContainerT, value_type<ContainerT>>::value) {
+            for (auto it = begin(container); it != end(container);)
+                it = predOrItem(*it) ? container.erase(it) : std::next(it);
+        } else {
+            container.erase(std::remove_if(begin(container), end(container), std::forward<T>(predOrItem)),
+                            end(container));
+        }
+    } else if constexpr (detail::has_erase_key<ContainerT, T>::value) {
+        container.erase(predOrItem);
+    } else {
         container.erase(std::remove(begin(container), end(container), std::forward<T>(predOrItem)), end(container));
+    }
 }
 
 // remove_duplicates
-template <typename ContainerT, typename EqualityCmp>
-void remove_duplicates(ContainerT& container, const EqualityCmp& cmp) {
+namespace detail {
+// shifts the elements for which keep(it, out) is true to the front, preserving their order, and erases the rest
+template <typename ContainerT, typename KeepT>
+void compact(ContainerT& container, KeepT&& keep) {
+    using std::begin;
+    using std::end;
+    auto out = begin(container);
+    for (auto it = begin(container); it != end(container); ++it) {
+        if (!keep(it, out))
+            continue;
+        if (out != it)
+            *out = std::move(*it);
+        ++out;
+    }
+    container.erase(out, end(container));
+}
+
+template <typename ContainerT>
+void remove_duplicates_hashed(ContainerT& container) {
+    using std::begin;
+    using std::end;
     using std::size;
-    auto n = size(container);
-    for (size_t i = 0; i < n; ++i) {
-        const auto& item = container[i];
-        for (size_t j = n - 1; j > i; --j) {
-            if (cmp(item, container[j])) {
-                container.erase(container.begin() + j);
-                --n;
-            }
+    using T = value_type<ContainerT>;
+    // proxy references, as std::vector<bool>'s, have no address to keep: the set holds the values
+    if constexpr (!std::is_lvalue_reference_v<typename std::iterator_traits<decltype(begin(container))>::reference>) {
+        auto seen = std::unordered_set<T>(size(container));
+        compact(container, [&](auto it, auto) { return seen.insert(*it).second; });
+    } else {
+        // the set points at the already compacted prefix, whose elements do not move anymore
+        auto hash = [](const T* t) { return std::hash<T>{}(*t); };
+        auto equal = [](const T* lhs, const T* rhs) { return *lhs == *rhs; };
+        auto seen = std::unordered_set<const T*, decltype(hash), decltype(equal)>(size(container), hash, equal);
+        auto out = begin(container);
+        for (auto it = begin(container); it != end(container); ++it) {
+            if (seen.count(&*it) != 0)
+                continue;
+            if (out != it)
+                *out = std::move(*it);
+            seen.insert(&*out);
+            ++out;
         }
+        container.erase(out, end(container));
     }
 }
 
+template <typename ContainerT>
+void remove_duplicates_sorted(ContainerT& container) {
+    using std::begin;
+    using std::size;
+    const auto n = size(container);
+    const auto first = begin(container);
+    auto order = std::vector<std::size_t>(n);
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+        if (first[lhs] < first[rhs])
+            return true;
+        if (first[rhs] < first[lhs])
+            return false;
+        return lhs < rhs;
+    });
+
+    // within a run of equal elements the first occurrence sorts first
+    auto keep = std::vector<char>(n, 0);
+    for (std::size_t i = 0; i < n; ++i)
+        keep[order[i]] = i == 0 || first[order[i - 1]] < first[order[i]];
+    compact(container, [&](auto it, auto) { return keep[std::distance(first, it)] != 0; });
+}
+} // namespace detail
+
+// keeps the first occurrence of each element. custom comparators cost O(n^2) comparisons, the default one hashes the
+// elements when std::hash is available and sorts indices when only operator< is.
+template <typename ContainerT, typename EqualityCmp>
+void remove_duplicates(ContainerT& container, const EqualityCmp& cmp) {
+    using std::begin;
+    const auto first = begin(container);
+    detail::compact(container, [&](auto it, auto out) {
+        return std::none_of(first, out, [&](const auto& kept) { return cmp(kept, *it); });
+    });
+}
+
 template <typename ContainerT>
 void remove_duplicates(ContainerT& container) {
-    remove_duplicates(container, std::equal_to{});
+    using T = value_type<ContainerT>;
+    if constexpr (mleivo::type_traits::is_hashable_v<T> && mleivo::type_traits::is_equality_comparable_v<T>)
+        detail::remove_duplicates_hashed(container);
+    else if constexpr (mleivo::type_traits::is_less_than_comparable_v<T>)
+        detail::remove_duplicates_sorted(container);
+    else
+        remove_duplicates(container, std::equal_to{});
 }
 
 template <typename ContainerT>
@@ -388,9 +1148,9 @@ auto reverse(ContainerT&& container) {
     return out;
 }
 
-template <typename ContainerT>
-std::vector<std::decay_t<ContainerT>> split(ContainerT&& c, const value_type<ContainerT>& separator) {
-    auto out = std::vector<std::decay_t<ContainerT>>{};
+namespace detail {
+template <typename OutT, typename ContainerT>
+void split(OutT& out, ContainerT&& c, const value_type<ContainerT>& separator) {
     out.emplace_back();
     for (auto&& value : c) {
         if (value == separator) {
@@ -400,45 +1160,315 @@ std::vector<std::decay_t<ContainerT>> split(ContainerT&& c, const value_type<Con
 
         if constexpr (std::is_rvalue_reference_v<decltype(c)>
                       && std::is_move_constructible_v<value_type<decltype(c)>>) {
-            out.back().emplace_back(std::move(value));
+            out.back().push_back(std::move(value));
         } else {
             out.back().push_back(value);
         }
     }
+}
+
+// writes the pieces through out. a forward iterator refills the pieces already there, keeping their capacity
+template <typename OutIt, typename ContainerT>
+OutIt split_to(OutIt out, ContainerT&& c, const value_type<ContainerT>& separator) {
+    constexpr auto move =
+        std::is_rvalue_reference_v<decltype(c)> && std::is_move_constructible_v<value_type<decltype(c)>>;
+    constexpr auto refill = std::is_base_of_v<std::forward_iterator_tag,
+                                              typename std::iterator_traits<OutIt>::iterator_category>;
+    auto piece = std::conditional_t<refill, empty_struct, std::decay_t<ContainerT>>{};
+    auto current = [&]() -> auto& {
+        if constexpr (refill)
+            return *out;
+        else
+            return piece;
+    };
+    current().clear();
+    for (auto&& value : c) {
+        if (value == separator) {
+            if constexpr (!refill)
+                *out = std::move(piece);
+            ++out;
+            current().clear();
+            continue;
+        }
+
+        if constexpr (move)
+            current().push_back(std::move(value));
+        else
+            current().push_back(value);
+    }
+    if constexpr (!refill)
+        *out = std::move(piece);
+    return ++out;
+}
+} // namespace detail
 
+// split<OutT>(c, separator) collects the pieces, of OutT's value_type, in an OutT instead of a std::vector of c's type
+template <typename OutT = void, typename ContainerT>
+auto split(ContainerT&& c, const value_type<ContainerT>& separator) {
+    auto out = std::conditional_t<std::is_void_v<OutT>, std::vector<std::decay_t<ContainerT>>, OutT>{};
+    detail::split(out, std::forward<ContainerT>(c), separator);
     return out;
 }
 
+// the outer std::vector uses alloc, or is a std::pmr::vector for a std::pmr::memory_resource*, and pmr pieces get the
+// same resource through uses-allocator construction
+template <typename AllocT, typename ContainerT>
+auto split(std::allocator_arg_t, const AllocT& alloc, ContainerT&& c, const value_type<ContainerT>& separator) {
+    auto out = detail::make_vector<std::decay_t<ContainerT>>(alloc);
+    detail::split(out, std::forward<ContainerT>(c), separator);
+    return out;
+}
+
+// split_into(out, c, separator) appends the pieces to the container out, or writes them through the iterator out and
+// returns the iterator past the last one. an iterator into existing pieces, such as out.begin() of a container that
+// has enough of them, refills them in place, so that splitting batch after batch stops allocating
+template <typename OutT, typename ContainerT>
+decltype(auto) split_into(OutT&& out, ContainerT&& c, const value_type<ContainerT>& separator) {
+    if constexpr (detail::is_sink_container_v<OutT>) {
+        static_assert(std::is_lvalue_reference_v<OutT>, "the output container has to outlive the call");
+        detail::split(out, std::forward<ContainerT>(c), separator);
+        return (out);
+    } else {
+        return detail::split_to(std::decay_t<OutT>(out), std::forward<ContainerT>(c), separator);
+    }
+}
+
+// split_view: lazily yields the pieces of a contiguous container as string_views (character types) or spans into
+// the original storage, nothing is copied. the container has to outlive the view.
+namespace detail {
+template <typename T>
+inline constexpr bool is_char_v = std::is_same_v<T, char> || std::is_same_v<T, wchar_t>
+                                  || std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>;
+
+template <typename T>
+struct is_view : std::false_type {};
+
+template <typename CharT, typename Traits>
+struct is_view<std::basic_string_view<CharT, Traits>> : std::true_type {};
+
+template <typename T>
+struct is_view<span<T>> : std::true_type {};
+
+template <typename ContainerT>
+using data_t = std::remove_reference_t<decltype(*std::data(std::declval<ContainerT&>()))>;
+
+template <typename ContainerT>
+using slice_t = std::conditional_t<is_char_v<value_type<ContainerT>>, std::basic_string_view<value_type<ContainerT>>,
+                                   span<data_t<ContainerT>>>;
+
+template <typename SliceT, typename FinderT>
+struct split_range {
+    using pointer = decltype(std::declval<SliceT>().data());
+    using value_type = SliceT;
+
+    struct iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = SliceT;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const SliceT*;
+        using reference = SliceT;
+
+        SliceT operator*() const {
+            return SliceT(m_first, static_cast<std::size_t>(m_sep - m_first));
+        }
+        iterator& operator++() {
+            if (m_sep == m_range->m_last) {
+                m_done = true;
+                return *this;
+            }
+            m_first = m_sep + m_range->m_separator_size;
+            m_sep = m_range->m_find(m_first, m_range->m_last);
+            return *this;
+        }
+        iterator operator++(int) {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+        friend bool operator==(const iterator& lhs, const iterator& rhs) {
+            return lhs.m_done == rhs.m_done && (lhs.m_done || lhs.m_first == rhs.m_first);
+        }
+        friend bool operator!=(const iterator& lhs, const iterator& rhs) {
+            return !(lhs == rhs);
+        }
+
+        typename split_range::pointer m_first;
+        typename split_range::pointer m_sep;
+        const split_range* m_range;
+        bool m_done;
+    };
+
+    iterator begin() const {
+        return iterator{m_first, m_find(m_first, m_last), this, false};
+    }
+    iterator end() const {
+        return iterator{m_last, m_last, this, true};
+    }
+
+    pointer m_first;
+    pointer m_last;
+    FinderT m_find;
+    std::size_t m_separator_size;
+};
+
+template <typename ContainerT>
+constexpr void check_split_view_input() {
+    static_assert(std::is_lvalue_reference_v<ContainerT> || is_view<std::decay_t<ContainerT>>::value,
+                  "split_view of an rvalue container would dangle");
+}
+} // namespace detail
+
+template <typename ContainerT>
+auto split_view(ContainerT&& c, const value_type<ContainerT>& separator) {
+    using std::data;
+    using std::size;
+    using SliceT = detail::slice_t<ContainerT>;
+    detail::check_split_view_input<ContainerT>();
+    auto find = [sep = separator](auto first, auto last) { return mleivo::simd::find(first, last, sep); };
+    return detail::split_range<SliceT, decltype(find)>{data(c), data(c) + size(c), std::move(find), 1};
+}
+
+template <typename ContainerT, typename = std::enable_if_t<detail::is_char_v<value_type<ContainerT>>>>
+auto split_view(ContainerT&& c, std::basic_string_view<value_type<ContainerT>> delimiter) {
+    using std::data;
+    using std::size;
+    using CharT = value_type<ContainerT>;
+    using SliceT = detail::slice_t<ContainerT>;
+    detail::check_split_view_input<ContainerT>();
+    assert(!delimiter.empty());
+    auto find = [delimiter](auto first, auto last) {
+        const auto pos = std::basic_string_view<CharT>(first, static_cast<std::size_t>(last - first)).find(delimiter);
+        return pos == std::basic_string_view<CharT>::npos ? last : first + pos;
+    };
+    return detail::split_range<SliceT, decltype(find)>{data(c), data(c) + size(c), std::move(find),
+                                                       delimiter.size()};
+}
+
 // transform
-template <typename ContainerT, typename TransformerT>
+// the result is written straight into a pre-sized output, and an rvalue input whose type the result shares is
+// transformed in place and returned
+namespace detail {
+template <typename OutIt, typename It, typename TransformerT>
+OutIt transform_to(OutIt out, It first, It last, TransformerT& t) {
+    using t_ret_val = decltype(t(*first));
+    for (; first != last; ++first, ++out) {
+        if constexpr (std::is_move_constructible_v<t_ret_val>) {
+            *out = t(*first);
+        } else {
+            auto tmp = t(*first);
+            *out = tmp;
+        }
+    }
+    return out;
+}
+
+template <typename ContainerT>
+auto transform_range(ContainerT&& c) {
+    using std::begin;
+    using std::end;
+    constexpr auto move = std::is_rvalue_reference_v<decltype(c)>
+                          && std::is_move_constructible_v<value_type<ContainerT>>;
+    return std::pair(move_iterator_if<move>(begin(c)), move_iterator_if<move>(end(c)));
+}
+
+template <typename OutT, typename ContainerT, typename TransformerT>
+void transform(OutT& out, ContainerT&& c, TransformerT& t) {
+    using std::begin;
+    using t_ret_val = decltype(std::declval<TransformerT>()(std::declval<value_type<ContainerT>>()));
+    auto [first, last] = transform_range(std::forward<ContainerT>(c));
+    if constexpr (mleivo::type_traits::has_method_size_v<ContainerT> && mleivo::type_traits::has_method_resize_v<OutT>
+                  && std::is_trivially_default_constructible_v<t_ret_val>) {
+        const auto old_size = out.size();
+        reserve_more(out, c.size());
+        out.resize(old_size + c.size());
+        std::transform(first, last, std::next(begin(out), old_size), t);
+    } else {
+        if constexpr (mleivo::type_traits::has_method_size_v<ContainerT>)
+            reserve_more(out, c.size());
+        transform_to(std::back_inserter(out), first, last, t);
+    }
+}
+} // namespace detail
+
+// transform<OutT>(c, t) returns an OutT, such as a small_vector, instead of the default
+template <typename OutT = void, typename ContainerT, typename TransformerT>
 auto transform(ContainerT&& c, TransformerT&& t) {
+    using in_t = value_type<ContainerT>;
     using t_ret_val = decltype(std::declval<TransformerT>()(std::declval<value_type<ContainerT>>()));
-    std::conditional_t<std::is_same_v<value_type<ContainerT>, t_ret_val>, std::decay_t<ContainerT>,
-                       std::vector<t_ret_val>>
-        out;
-    if constexpr (std::is_rvalue_reference_v<decltype(c)> && std::is_move_constructible_v<value_type<decltype(out)>>) {
-        std::transform(std::make_move_iterator(std::begin(c)), std::make_move_iterator(std::end(c)),
-                       std::back_inserter(out), std::forward<TransformerT>(t));
+    using default_t = std::conditional_t<std::is_same_v<value_type<ContainerT>, t_ret_val>, std::decay_t<ContainerT>,
+                                         std::vector<t_ret_val>>;
+    using out_t = std::conditional_t<std::is_void_v<OutT>, default_t, OutT>;
+    constexpr auto is_rvalue = std::is_rvalue_reference_v<decltype(c)>;
+    if constexpr (is_rvalue && std::is_same_v<out_t, std::decay_t<ContainerT>>
+                  && !std::is_const_v<std::remove_reference_t<ContainerT>> && std::is_move_assignable_v<in_t>) {
+        using std::begin;
+        using std::end;
+        // through the iterators, since the reference of a std::vector<bool> is a proxy
+        for (auto it = begin(c); it != end(c); ++it)
+            *it = t(std::move(*it));
+        return out_t(std::move(c));
     } else {
-        for (auto i : c) {
-            auto tmp = t(i);
-            out.push_back(tmp);
-        }
+        auto out = out_t();
+        detail::transform(out, std::forward<ContainerT>(c), t);
+        return out;
     }
+}
+
+// into a std::vector using alloc, or a std::pmr::vector for a std::pmr::memory_resource*
+template <typename AllocT, typename ContainerT, typename TransformerT>
+auto transform(std::allocator_arg_t, const AllocT& alloc, ContainerT&& c, TransformerT&& t) {
+    using t_ret_val = decltype(std::declval<TransformerT>()(std::declval<value_type<ContainerT>>()));
+    auto out = detail::make_vector<t_ret_val>(alloc);
+    detail::transform(out, std::forward<ContainerT>(c), t);
     return out;
 }
 
+// transform_into(out, c, t) appends the results to the container out, reusing its capacity, or writes them through
+// the output iterator out and returns the iterator past the last one
+template <typename OutT, typename ContainerT, typename TransformerT>
+decltype(auto) transform_into(OutT&& out, ContainerT&& c, TransformerT&& t) {
+    if constexpr (detail::is_sink_container_v<OutT>) {
+        static_assert(std::is_lvalue_reference_v<OutT>, "the output container has to outlive the call");
+        detail::transform(out, std::forward<ContainerT>(c), t);
+        return (out);
+    } else {
+        auto [first, last] = detail::transform_range(std::forward<ContainerT>(c));
+        return detail::transform_to(std::decay_t<OutT>(out), first, last, t);
+    }
+}
+
 // to_std_vector
-template <typename ContainerT>
-std::vector<value_type<ContainerT>> to_std_vector(ContainerT&& c) {
-    std::vector<value_type<ContainerT>> out;
-    if constexpr (std::is_rvalue_reference_v<decltype(c)> && std::is_move_constructible_v<value_type<decltype(c)>>) {
+namespace detail {
+template <typename OutT, typename ContainerT>
+OutT to_vector(OutT out, ContainerT&& c) {
+    constexpr auto is_rvalue =
+        std::is_rvalue_reference_v<decltype(c)> && !std::is_const_v<std::remove_reference_t<ContainerT>>;
+    if constexpr (is_rvalue && std::is_move_constructible_v<value_type<decltype(c)>>) {
         out.insert(out.end(), std::make_move_iterator(std::begin(c)), std::make_move_iterator(std::end(c)));
     } else {
+        if constexpr (mleivo::type_traits::has_method_size_v<ContainerT>)
+            out.reserve(c.size());
         std::copy(std::begin(c), std::end(c), std::back_inserter(out));
     }
     return out;
 }
+} // namespace detail
+
+// an rvalue std::vector is returned as is, other containers are copied or moved into one allocation
+template <typename ContainerT>
+std::vector<value_type<ContainerT>> to_std_vector(ContainerT&& c) {
+    using out_t = std::vector<value_type<ContainerT>>;
+    if constexpr (std::is_same_v<ContainerT, out_t>) // an rvalue
+        return std::move(c);
+    else
+        return detail::to_vector(out_t(), std::forward<ContainerT>(c));
+}
+
+// into a std::vector using alloc, or a std::pmr::vector for a std::pmr::memory_resource*
+template <typename AllocT, typename ContainerT>
+auto to_std_vector(std::allocator_arg_t, const AllocT& alloc, ContainerT&& c) {
+    return detail::to_vector(detail::make_vector<value_type<ContainerT>>(alloc), std::forward<ContainerT>(c));
+}
 } // namespace mleivo::cu
 
 namespace std {
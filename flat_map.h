@@ -0,0 +1,679 @@
+/*
+ * Copyright 2023 Marcus Leivo
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mleivo::cu {
+// tag for the constructors and inserts that take input already sorted and free of duplicates
+struct sorted_unique_t {
+    explicit sorted_unique_t() = default;
+};
+inline constexpr sorted_unique_t sorted_unique{};
+
+namespace detail {
+// lower_bound over [first, first + n) that halves the range with a conditional move instead of a branch, so the
+// lookup does not pay for a misprediction at every level
+template <typename T, typename K, typename Compare>
+const T* branchless_lower_bound(const T* first, std::size_t n, const K& key, const Compare& cmp) {
+    if (n == 0)
+        return first;
+    while (n > 1) {
+        const auto half = n / 2;
+        first = cmp(first[half - 1], key) ? first + half : first;
+        n -= half;
+    }
+    return first + (cmp(*first, key) ? 1 : 0);
+}
+
+template <typename T, typename K, typename Compare>
+const T* branchless_upper_bound(const T* first, std::size_t n, const K& key, const Compare& cmp) {
+    if (n == 0)
+        return first;
+    while (n > 1) {
+        const auto half = n / 2;
+        first = cmp(key, first[half - 1]) ? first : first + half;
+        n -= half;
+    }
+    return first + (cmp(key, *first) ? 0 : 1);
+}
+
+template <typename It>
+constexpr bool is_forward_iterator_v =
+    std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>;
+
+// the key and the mapped value at one index of a flat_map, handed out by reference. The values are walked with the
+// iterator of their std::vector, whose reference is a proxy for a std::vector<bool>
+template <typename Key, typename T, bool Const>
+struct flat_map_iterator {
+    using mapped_iterator =
+        std::conditional_t<Const, typename std::vector<T>::const_iterator, typename std::vector<T>::iterator>;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::pair<Key, T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const Key&, typename std::iterator_traits<mapped_iterator>::reference>;
+    struct pointer {
+        reference* operator->() {
+            return &m_ref;
+        }
+        reference m_ref;
+    };
+
+    flat_map_iterator() = default;
+    flat_map_iterator(const Key* key, mapped_iterator value) : m_key(key), m_value(value) {
+    }
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    flat_map_iterator(const flat_map_iterator<Key, T, false>& rhs) : m_key(rhs.m_key), m_value(rhs.m_value) {
+    }
+
+    reference operator*() const {
+        return {*m_key, *m_value};
+    }
+    pointer operator->() const {
+        return {**this};
+    }
+    reference operator[](difference_type n) const {
+        return *(*this + n);
+    }
+
+    flat_map_iterator& operator++() {
+        ++m_key;
+        ++m_value;
+        return *this;
+    }
+    flat_map_iterator operator++(int) {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
+    flat_map_iterator& operator--() {
+        --m_key;
+        --m_value;
+        return *this;
+    }
+    flat_map_iterator operator--(int) {
+        auto tmp = *this;
+        --*this;
+        return tmp;
+    }
+    flat_map_iterator& operator+=(difference_type n) {
+        m_key += n;
+        m_value += n;
+        return *this;
+    }
+    flat_map_iterator& operator-=(difference_type n) {
+        return *this += -n;
+    }
+    friend flat_map_iterator operator+(flat_map_iterator it, difference_type n) {
+        return it += n;
+    }
+    friend flat_map_iterator operator+(difference_type n, flat_map_iterator it) {
+        return it += n;
+    }
+    friend flat_map_iterator operator-(flat_map_iterator it, difference_type n) {
+        return it -= n;
+    }
+    friend difference_type operator-(const flat_map_iterator& lhs, const flat_map_iterator& rhs) {
+        return lhs.m_key - rhs.m_key;
+    }
+
+    friend bool operator==(const flat_map_iterator& lhs, const flat_map_iterator& rhs) {
+        return lhs.m_key == rhs.m_key;
+    }
+    friend bool operator!=(const flat_map_iterator& lhs, const flat_map_iterator& rhs) {
+        return lhs.m_key != rhs.m_key;
+    }
+    friend bool operator<(const flat_map_iterator& lhs, const flat_map_iterator& rhs) {
+        return lhs.m_key < rhs.m_key;
+    }
+    friend bool operator>(const flat_map_iterator& lhs, const flat_map_iterator& rhs) {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const flat_map_iterator& lhs, const flat_map_iterator& rhs) {
+        return !(rhs < lhs);
+    }
+    friend bool operator>=(const flat_map_iterator& lhs, const flat_map_iterator& rhs) {
+        return !(lhs < rhs);
+    }
+
+    const Key* m_key = nullptr;
+    mapped_iterator m_value{};
+};
+} // namespace detail
+
+// flat_set: the keys sorted in one std::vector, so lookups are binary searches over contiguous memory. Inserting one
+// key shifts the ones after it, batches go through insert(first, last), which appends, sorts the batch and merges it
+// in linearly. Of equivalent keys the one already in the set, or else the first of the batch, is kept
+template <typename Key, typename Compare = std::less<Key>>
+class flat_set {
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = const Key&;
+    using const_reference = const Key&;
+    using container_type = std::vector<Key>;
+    using iterator = typename container_type::const_iterator;
+    using const_iterator = iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = reverse_iterator;
+
+    flat_set() = default;
+    explicit flat_set(const Compare& cmp) : m_cmp(cmp) {
+    }
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    flat_set(InputIt first, InputIt last, const Compare& cmp = Compare()) : m_cmp(cmp) {
+        insert(first, last);
+    }
+    flat_set(std::initializer_list<Key> keys, const Compare& cmp = Compare())
+        : flat_set(keys.begin(), keys.end(), cmp) {
+    }
+    explicit flat_set(container_type keys, const Compare& cmp = Compare()) : m_keys(std::move(keys)), m_cmp(cmp) {
+        sort_and_merge(0);
+    }
+    flat_set(sorted_unique_t, container_type keys, const Compare& cmp = Compare())
+        : m_keys(std::move(keys)), m_cmp(cmp) {
+    }
+
+    iterator begin() const noexcept {
+        return m_keys.begin();
+    }
+    iterator end() const noexcept {
+        return m_keys.end();
+    }
+    iterator cbegin() const noexcept {
+        return begin();
+    }
+    iterator cend() const noexcept {
+        return end();
+    }
+    reverse_iterator rbegin() const noexcept {
+        return reverse_iterator(end());
+    }
+    reverse_iterator rend() const noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const Key* data() const noexcept {
+        return m_keys.data();
+    }
+    size_type size() const noexcept {
+        return m_keys.size();
+    }
+    size_type capacity() const noexcept {
+        return m_keys.capacity();
+    }
+    bool empty() const noexcept {
+        return m_keys.empty();
+    }
+    void reserve(size_type capacity) {
+        m_keys.reserve(capacity);
+    }
+    void clear() noexcept {
+        m_keys.clear();
+    }
+    const container_type& keys() const noexcept {
+        return m_keys;
+    }
+    container_type extract() && {
+        return std::move(m_keys);
+    }
+    key_compare key_comp() const {
+        return m_cmp;
+    }
+    value_compare value_comp() const {
+        return m_cmp;
+    }
+
+    template <typename K>
+    iterator lower_bound(const K& key) const {
+        return begin() + (detail::branchless_lower_bound(data(), size(), key, m_cmp) - data());
+    }
+    template <typename K>
+    iterator upper_bound(const K& key) const {
+        return begin() + (detail::branchless_upper_bound(data(), size(), key, m_cmp) - data());
+    }
+    template <typename K>
+    std::pair<iterator, iterator> equal_range(const K& key) const {
+        const auto first = lower_bound(key);
+        return {first, first != end() && !m_cmp(key, *first) ? std::next(first) : first};
+    }
+    template <typename K>
+    iterator find(const K& key) const {
+        const auto it = lower_bound(key);
+        return it != end() && !m_cmp(key, *it) ? it : end();
+    }
+    template <typename K>
+    bool contains(const K& key) const {
+        return find(key) != end();
+    }
+    template <typename K>
+    size_type count(const K& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    std::pair<iterator, bool> insert(const Key& key) {
+        return emplace(key);
+    }
+    std::pair<iterator, bool> insert(Key&& key) {
+        return emplace(std::move(key));
+    }
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        auto key = Key(std::forward<Args>(args)...);
+        const auto it = lower_bound(key);
+        if (it != end() && !m_cmp(key, *it))
+            return {it, false};
+        return {m_keys.insert(it, std::move(key)), true};
+    }
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void insert(InputIt first, InputIt last) {
+        const auto old_size = size();
+        m_keys.insert(m_keys.end(), first, last);
+        sort_and_merge(old_size);
+    }
+    void insert(std::initializer_list<Key> keys) {
+        insert(keys.begin(), keys.end());
+    }
+    // the batch is already sorted and without duplicates of its own, so only the merge is left
+    template <typename InputIt>
+    void insert(sorted_unique_t, InputIt first, InputIt last) {
+        const auto old_size = size();
+        m_keys.insert(m_keys.end(), first, last);
+        merge_tail(old_size);
+    }
+    void merge(const flat_set& other) {
+        if (&other != this)
+            insert(sorted_unique, other.begin(), other.end());
+    }
+
+    iterator erase(iterator pos) {
+        return m_keys.erase(pos);
+    }
+    iterator erase(iterator first, iterator last) {
+        return m_keys.erase(first, last);
+    }
+    template <typename K, typename = std::enable_if_t<!std::is_convertible_v<const K&, iterator>>>
+    size_type erase(const K& key) {
+        const auto [first, last] = equal_range(key);
+        const auto count = static_cast<size_type>(last - first);
+        m_keys.erase(first, last);
+        return count;
+    }
+    // removing keeps the order, so the keys stay sorted
+    template <typename Pred>
+    size_type erase_if(Pred pred) {
+        const auto old_size = size();
+        m_keys.erase(std::remove_if(m_keys.begin(), m_keys.end(), pred), m_keys.end());
+        return old_size - size();
+    }
+
+    void swap(flat_set& rhs) noexcept {
+        using std::swap;
+        swap(m_keys, rhs.m_keys);
+        swap(m_cmp, rhs.m_cmp);
+    }
+    friend void swap(flat_set& lhs, flat_set& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+    friend bool operator==(const flat_set& lhs, const flat_set& rhs) {
+        return lhs.m_keys == rhs.m_keys;
+    }
+    friend bool operator!=(const flat_set& lhs, const flat_set& rhs) {
+        return !(lhs == rhs);
+    }
+    friend bool operator<(const flat_set& lhs, const flat_set& rhs) {
+        return lhs.m_keys < rhs.m_keys;
+    }
+
+private:
+    bool equivalent(const Key& lhs, const Key& rhs) const {
+        return !m_cmp(lhs, rhs) && !m_cmp(rhs, lhs);
+    }
+
+    void sort_and_merge(size_type old_size) {
+        const auto mid = m_keys.begin() + static_cast<difference_type>(old_size);
+        if (!std::is_sorted(mid, m_keys.end(), m_cmp))
+            std::stable_sort(mid, m_keys.end(), m_cmp);
+        m_keys.erase(std::unique(mid, m_keys.end(), [this](const Key& l, const Key& r) { return equivalent(l, r); }),
+                     m_keys.end());
+        merge_tail(old_size);
+    }
+
+    // merges the sorted, unique keys from old_size on into the ones before, dropping the ones already there
+    void merge_tail(size_type old_size) {
+        const auto mid = m_keys.begin() + static_cast<difference_type>(old_size);
+        if (mid == m_keys.begin() || mid == m_keys.end() || m_cmp(*std::prev(mid), *mid))
+            return;
+        std::inplace_merge(m_keys.begin(), mid, m_keys.end(), m_cmp);
+        m_keys.erase(std::unique(m_keys.begin(), m_keys.end(),
+                                 [this](const Key& l, const Key& r) { return equivalent(l, r); }),
+                     m_keys.end());
+    }
+
+    container_type m_keys;
+    Compare m_cmp;
+};
+
+// flat_map: the sorted keys and their values in two std::vectors, so a lookup only touches keys. The iterators hand
+// out a pair of references, std::pair<const Key&, T&>. Inserting follows flat_set: batches are sorted and merged in
+// and of equivalent keys the one already in the map, or else the first of the batch, is kept
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class flat_map {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using key_compare = Compare;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using iterator = detail::flat_map_iterator<Key, T, false>;
+    using const_iterator = detail::flat_map_iterator<Key, T, true>;
+    using reference = typename iterator::reference;
+    using const_reference = typename const_iterator::reference;
+    using key_container_type = std::vector<Key>;
+    using mapped_container_type = std::vector<T>;
+
+    flat_map() = default;
+    explicit flat_map(const Compare& cmp) : m_cmp(cmp) {
+    }
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    flat_map(InputIt first, InputIt last, const Compare& cmp = Compare()) : m_cmp(cmp) {
+        insert(first, last);
+    }
+    flat_map(std::initializer_list<value_type> values, const Compare& cmp = Compare())
+        : flat_map(values.begin(), values.end(), cmp) {
+    }
+    flat_map(sorted_unique_t, key_container_type keys, mapped_container_type values, const Compare& cmp = Compare())
+        : m_keys(std::move(keys)), m_values(std::move(values)), m_cmp(cmp) {
+    }
+
+    iterator begin() noexcept {
+        return {m_keys.data(), m_values.begin()};
+    }
+    iterator end() noexcept {
+        return begin() + static_cast<difference_type>(size());
+    }
+    const_iterator begin() const noexcept {
+        return {m_keys.data(), m_values.begin()};
+    }
+    const_iterator end() const noexcept {
+        return begin() + static_cast<difference_type>(size());
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_type size() const noexcept {
+        return m_keys.size();
+    }
+    size_type capacity() const noexcept {
+        return std::min(m_keys.capacity(), m_values.capacity());
+    }
+    bool empty() const noexcept {
+        return m_keys.empty();
+    }
+    void reserve(size_type capacity) {
+        m_keys.reserve(capacity);
+        m_values.reserve(capacity);
+    }
+    void clear() noexcept {
+        m_keys.clear();
+        m_values.clear();
+    }
+    const key_container_type& keys() const noexcept {
+        return m_keys;
+    }
+    const mapped_container_type& values() const noexcept {
+        return m_values;
+    }
+    key_compare key_comp() const {
+        return m_cmp;
+    }
+
+    template <typename K>
+    iterator lower_bound(const K& key) {
+        return begin() + index_of_lower_bound(key);
+    }
+    template <typename K>
+    const_iterator lower_bound(const K& key) const {
+        return begin() + index_of_lower_bound(key);
+    }
+    template <typename K>
+    iterator upper_bound(const K& key) {
+        return begin() + index_of_upper_bound(key);
+    }
+    template <typename K>
+    const_iterator upper_bound(const K& key) const {
+        return begin() + index_of_upper_bound(key);
+    }
+    template <typename K>
+    iterator find(const K& key) {
+        const auto i = index_of_lower_bound(key);
+        return found(i, key) ? begin() + i : end();
+    }
+    template <typename K>
+    const_iterator find(const K& key) const {
+        const auto i = index_of_lower_bound(key);
+        return found(i, key) ? begin() + i : end();
+    }
+    template <typename K>
+    bool contains(const K& key) const {
+        return found(index_of_lower_bound(key), key);
+    }
+    template <typename K>
+    size_type count(const K& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    template <typename K>
+    typename mapped_container_type::reference at(const K& key) {
+        return m_values[index_of_existing(key)];
+    }
+    template <typename K>
+    typename mapped_container_type::const_reference at(const K& key) const {
+        return m_values[index_of_existing(key)];
+    }
+    typename mapped_container_type::reference operator[](const Key& key) {
+        return (*try_emplace(key).first).second;
+    }
+    typename mapped_container_type::reference operator[](Key&& key) {
+        return (*try_emplace(std::move(key)).first).second;
+    }
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        const auto i = index_of_lower_bound(key);
+        if (found(i, key))
+            return {begin() + i, false};
+        m_keys.insert(m_keys.begin() + i, std::forward<K>(key));
+        m_values.insert(m_values.begin() + i, T(std::forward<Args>(args)...));
+        return {begin() + i, true};
+    }
+    template <typename K, typename M>
+    std::pair<iterator, bool> insert_or_assign(K&& key, M&& value) {
+        auto out = try_emplace(std::forward<K>(key), std::forward<M>(value));
+        if (!out.second)
+            (*out.first).second = std::forward<M>(value);
+        return out;
+    }
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return try_emplace(value.first, value.second);
+    }
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return try_emplace(std::move(value.first), std::move(value.second));
+    }
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void insert(InputIt first, InputIt last) {
+        auto batch = std::vector<value_type>(first, last);
+        std::stable_sort(batch.begin(), batch.end(),
+                         [this](const value_type& l, const value_type& r) { return m_cmp(l.first, r.first); });
+        batch.erase(std::unique(batch.begin(), batch.end(),
+                                [this](const value_type& l, const value_type& r) { return !m_cmp(l.first, r.first); }),
+                    batch.end());
+        merge_sorted_batch(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    }
+    void insert(std::initializer_list<value_type> values) {
+        insert(values.begin(), values.end());
+    }
+    // the batch is already sorted by key and without duplicates of its own, so only the merge is left
+    template <typename InputIt>
+    void insert(sorted_unique_t, InputIt first, InputIt last) {
+        merge_sorted_batch(first, last);
+    }
+    void merge(const flat_map& other) {
+        if (&other != this)
+            insert(sorted_unique, other.begin(), other.end());
+    }
+
+    iterator erase(const_iterator pos) {
+        const auto i = pos - cbegin();
+        m_keys.erase(m_keys.begin() + i);
+        m_values.erase(m_values.begin() + i);
+        return begin() + i;
+    }
+    iterator erase(const_iterator first, const_iterator last) {
+        const auto i = first - cbegin();
+        const auto j = last - cbegin();
+        m_keys.erase(m_keys.begin() + i, m_keys.begin() + j);
+        m_values.erase(m_values.begin() + i, m_values.begin() + j);
+        return begin() + i;
+    }
+    template <typename K, typename = std::enable_if_t<!std::is_convertible_v<const K&, const_iterator>>>
+    size_type erase(const K& key) {
+        const auto it = find(key);
+        if (it == end())
+            return 0;
+        erase(it);
+        return 1;
+    }
+    // pred sees a const_reference, the pair of the key and the value
+    template <typename Pred>
+    size_type erase_if(Pred pred) {
+        auto out = size_type{0};
+        for (size_type i = 0; i < size(); ++i) {
+            if (pred(const_reference(m_keys[i], m_values[i])))
+                continue;
+            if (out != i) {
+                m_keys[out] = std::move(m_keys[i]);
+                m_values[out] = std::move(m_values[i]);
+            }
+            ++out;
+        }
+        const auto removed = size() - out;
+        m_keys.erase(m_keys.begin() + static_cast<difference_type>(out), m_keys.end());
+        m_values.erase(m_values.begin() + static_cast<difference_type>(out), m_values.end());
+        return removed;
+    }
+
+    void swap(flat_map& rhs) noexcept {
+        using std::swap;
+        swap(m_keys, rhs.m_keys);
+        swap(m_values, rhs.m_values);
+        swap(m_cmp, rhs.m_cmp);
+    }
+    friend void swap(flat_map& lhs, flat_map& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+    friend bool operator==(const flat_map& lhs, const flat_map& rhs) {
+        return lhs.m_keys == rhs.m_keys && lhs.m_values == rhs.m_values;
+    }
+    friend bool operator!=(const flat_map& lhs, const flat_map& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    template <typename K>
+    difference_type index_of_lower_bound(const K& key) const {
+        return detail::branchless_lower_bound(m_keys.data(), m_keys.size(), key, m_cmp) - m_keys.data();
+    }
+    template <typename K>
+    difference_type index_of_upper_bound(const K& key) const {
+        return detail::branchless_upper_bound(m_keys.data(), m_keys.size(), key, m_cmp) - m_keys.data();
+    }
+    template <typename K>
+    bool found(difference_type i, const K& key) const {
+        return static_cast<size_type>(i) != size() && !m_cmp(key, m_keys[static_cast<size_type>(i)]);
+    }
+    template <typename K>
+    size_type index_of_existing(const K& key) const {
+        const auto i = index_of_lower_bound(key);
+        if (!found(i, key))
+            throw std::out_of_range("flat_map::at");
+        return static_cast<size_type>(i);
+    }
+
+    // merges a batch sorted by key into the map. a batch past the last key is appended, anything else is merged into
+    // fresh storage in one linear pass
+    template <typename InputIt>
+    void merge_sorted_batch(InputIt first, InputIt last) {
+        if (first == last)
+            return;
+        if (empty() || m_cmp(m_keys.back(), (*first).first)) {
+            for (; first != last; ++first)
+                push_back(m_keys, m_values, *first);
+            return;
+        }
+        auto keys = key_container_type{};
+        auto values = mapped_container_type{};
+        if constexpr (detail::is_forward_iterator_v<InputIt>) {
+            keys.reserve(size() + static_cast<size_type>(std::distance(first, last)));
+            values.reserve(keys.capacity());
+        }
+        size_type i = 0;
+        while (i < size() || first != last) {
+            if (first == last || (i < size() && !m_cmp((*first).first, m_keys[i]))) {
+                if (first != last && !m_cmp(m_keys[i], (*first).first))
+                    ++first; // already in the map
+                keys.push_back(std::move(m_keys[i]));
+                values.push_back(std::move(m_values[i]));
+                ++i;
+            } else {
+                push_back(keys, values, *first);
+                ++first;
+            }
+        }
+        m_keys = std::move(keys);
+        m_values = std::move(values);
+    }
+
+    // moves the key and the value out of an rvalue pair and copies them from anything else
+    template <typename PairT>
+    static void push_back(key_container_type& keys, mapped_container_type& values, PairT&& pair) {
+        keys.push_back(std::get<0>(std::forward<PairT>(pair)));
+        values.push_back(std::get<1>(std::forward<PairT>(pair)));
+    }
+
+    key_container_type m_keys;
+    mapped_container_type m_values;
+    Compare m_cmp;
+};
+} // namespace mleivo::cu
@@ -16,33 +16,181 @@
  */
 #pragma once
 
+#include "thread_pool.h"
+
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <execution>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <numeric>
+#include <optional>
+#include <thread>
+#include <type_traits>
 #include <utility>
 
 #include <tuple>
 #include <vector>
 
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
 namespace mleivo::pipes {
 namespace detail {
+// result of `container | pipes::morsels`: element-wise stages are queued and run together, morsel by morsel
+template <typename ContainerT, typename... Stages>
+class morsel_bound;
+
+template <typename T>
+struct is_morsel_bound : std::false_type {};
+
+template <typename ContainerT, typename... Stages>
+struct is_morsel_bound<morsel_bound<ContainerT, Stages...>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_morsel_bound_v = is_morsel_bound<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+template <typename ContainerT, typename PolicyT>
+struct policy_bound;
+
+template <typename PolicyT>
+struct execution {
+    using mleivo_pipe_ret = std::true_type;
+    static constexpr PolicyT value{};
+
+    template <typename ContainerT>
+    constexpr auto operator()(ContainerT&& container) const {
+        if constexpr (is_morsel_bound_v<ContainerT>)
+            return (*this)(std::move(container).run());
+        else
+            return policy_bound<ContainerT, PolicyT>{std::forward<ContainerT>(container)};
+    }
+};
+
+template <typename T>
+struct is_execution_stage : std::false_type {};
+
+template <typename PolicyT>
+struct is_execution_stage<execution<PolicyT>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_execution_policy_v =
+    std::is_execution_policy_v<std::remove_cv_t<std::remove_reference_t<T>>>
+    || is_execution_stage<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+// policies are always handed to the std algorithms as lvalues, libstdc++'s pstl does not accept rvalue policies
+template <typename T>
+constexpr const auto& std_policy(const T& policy) {
+    if constexpr (is_execution_stage<T>::value)
+        return T::value;
+    else
+        return policy;
+}
+
+// result of `container | pipes::par`: the next stage runs its algorithm under PolicyT
+template <typename ContainerT, typename PolicyT>
+struct policy_bound {
+    using policy_type = PolicyT;
+
+    constexpr const PolicyT& policy() const {
+        return execution<PolicyT>::value;
+    }
+
+    ContainerT m_container;
+};
+
+template <typename T>
+struct is_policy_bound : std::false_type {};
+
+template <typename ContainerT, typename PolicyT>
+struct is_policy_bound<policy_bound<ContainerT, PolicyT>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_policy_bound_v = is_policy_bound<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+// stages that touch each element on its own, so they run on any split of the range. the others are pipeline breakers
+template <typename CallT>
+struct is_elementwise : std::false_type {};
+
+// a leading execution policy in the stage arguments goes in front of the range, as the std algorithms expect it
+template <typename CallT, typename It, typename PolicyT, typename... Args>
+constexpr decltype(auto) call_with_policy(It first, It last, PolicyT&& policy, Args&&... args) {
+    return CallT::call(std_policy(policy), first, last, std::forward<Args>(args)...);
+}
+
+template <typename CallT, typename It, typename... Args>
+constexpr decltype(auto) call(It first, It last, Args&&... args) {
+    if constexpr (sizeof...(Args) > 0) {
+        if constexpr (is_execution_policy_v<std::tuple_element_t<0, std::tuple<Args...>>>)
+            return call_with_policy<CallT>(first, last, std::forward<Args>(args)...);
+        else
+            return CallT::call(first, last, std::forward<Args>(args)...);
+    } else {
+        return CallT::call(first, last);
+    }
+}
+
+template <typename CallT, typename TupleT, typename ContainerT, typename... PolicyT>
+constexpr auto apply_stage(TupleT&& t, ContainerT& container, PolicyT&&... policy) {
+    return std::apply(
+        [&](auto&&... args) {
+            using std::begin;
+            using std::end;
+            return call<CallT>(begin(container), end(container), std::forward<PolicyT>(policy)...,
+                               std::forward<decltype(args)>(args)...);
+        },
+        std::forward<TupleT>(t));
+}
+
+// a stage holds its arguments by value, so a named one outlives the temporaries it was made from. A temporary stage
+// hands them on to the algorithm, a named one (or one in a pipeline) lends them as const lvalues, so it can run any
+// number of times, from any number of threads
 template <typename CallT, typename... Args>
 struct wrapper {
     using mleivo_pipe = std::true_type;
 
-    std::tuple<Args...> m_t;
+    std::tuple<std::decay_t<Args>...> m_t;
     constexpr wrapper(Args... args) : m_t(std::forward<Args>(args)...) {
     }
 
     template <typename ContainerT>
-    constexpr decltype(auto) operator()(ContainerT&& container) {
-        std::apply(
-            [&](auto&&... args) {
-                using std::begin;
-                using std::end;
-                CallT::call(begin(container), end(container), std::forward<decltype(args)>(args)...);
-            },
-            std::move(m_t));
-        return std::forward<decltype(container)>(container);
+    constexpr decltype(auto) operator()(ContainerT&& container) && {
+        return run(std::move(*this), std::forward<ContainerT>(container));
+    }
+
+    template <typename ContainerT>
+    constexpr decltype(auto) operator()(ContainerT&& container) const& {
+        return run(*this, std::forward<ContainerT>(container));
+    }
+
+    // the stage on [first, last), leaving the arguments in place: morsels run it once per morsel
+    template <typename It>
+    void run_on(It first, It last) const {
+        std::apply([&](auto&... args) { call<CallT>(first, last, args...); }, m_t);
+    }
+
+private:
+    template <typename SelfT, typename ContainerT>
+    static constexpr decltype(auto) run(SelfT&& self, ContainerT&& container) {
+        if constexpr (is_morsel_bound_v<ContainerT>) {
+            if constexpr (is_elementwise<CallT>::value)
+                return std::move(container).then(std::forward<SelfT>(self));
+            else
+                return std::forward<SelfT>(self)(std::move(container).run());
+        } else if constexpr (is_policy_bound_v<ContainerT>) {
+            apply_stage<CallT>(std::forward<SelfT>(self).m_t, container.m_container, container.policy());
+            return static_cast<decltype(container.m_container)&&>(container.m_container);
+        } else {
+            apply_stage<CallT>(std::forward<SelfT>(self).m_t, container);
+            return std::forward<decltype(container)>(container);
+        }
     }
 };
 
@@ -50,23 +198,1151 @@ template <typename CallT, typename... Args>
 struct ret_wrapper {
     using mleivo_pipe_ret = std::true_type;
 
-    std::tuple<Args...> m_t;
+    std::tuple<std::decay_t<Args>...> m_t;
     constexpr ret_wrapper(Args... args) : m_t(std::forward<Args>(args)...) {
     }
 
     template <typename ContainerT>
-    constexpr auto operator()(ContainerT&& container) {
-        return std::apply(
-            [&](auto&&... args) {
-                using std::begin;
-                using std::end;
-                return CallT::call(begin(container), end(container), std::forward<decltype(args)>(args)...);
-            },
-            std::move(m_t));
+    constexpr auto operator()(ContainerT&& container) && {
+        return run(std::move(*this), std::forward<ContainerT>(container));
+    }
+
+    template <typename ContainerT>
+    constexpr auto operator()(ContainerT&& container) const& {
+        return run(*this, std::forward<ContainerT>(container));
+    }
+
+private:
+    template <typename SelfT, typename ContainerT>
+    static constexpr auto run(SelfT&& self, ContainerT&& container) {
+        if constexpr (is_morsel_bound_v<ContainerT>)
+            return run(std::forward<SelfT>(self), std::move(container).run());
+        else if constexpr (is_policy_bound_v<ContainerT>)
+            return apply_stage<CallT>(std::forward<SelfT>(self).m_t, container.m_container, container.policy());
+        else
+            return apply_stage<CallT>(std::forward<SelfT>(self).m_t, container);
+    }
+};
+
+// accumulate is strictly left-to-right, under an execution policy it becomes std::reduce
+struct accumulate {
+    template <typename It, typename... Args, typename = std::enable_if_t<!is_execution_policy_v<It>>>
+    static constexpr auto call(It first, It last, Args&&... args) {
+        return std::accumulate(first, last, std::forward<Args>(args)...);
+    }
+
+    template <typename PolicyT, typename It, typename... Args,
+              typename = std::enable_if_t<is_execution_policy_v<PolicyT>>>
+    static auto call(PolicyT&& policy, It first, It last, Args&&... args) {
+        return std::reduce(std::forward<PolicyT>(policy), first, last, std::forward<Args>(args)...);
     }
 };
 } // namespace detail
 
+inline constexpr auto seq = detail::execution<std::execution::sequenced_policy>{};
+inline constexpr auto par = detail::execution<std::execution::parallel_policy>{};
+inline constexpr auto par_unseq = detail::execution<std::execution::parallel_unsequenced_policy>{};
+
+template <typename... Args>
+constexpr auto accumulate(Args&&... args) {
+    return detail::ret_wrapper<detail::accumulate, decltype(args)...>(std::forward<decltype(args)>(args)...);
+}
+
+// lazy views: stages below do not touch the container when piped, they wrap it in a view whose iterators apply the
+// stage on dereference. chained views nest their iterators, so a terminal stage walks the source exactly once.
+namespace detail {
+template <typename ContainerT>
+using iterator_t = decltype(std::begin(std::declval<ContainerT&>()));
+
+template <typename ContainerT>
+using reference_t = typename std::iterator_traits<iterator_t<ContainerT>>::reference;
+
+// a view's callable as its iterators hold it: every iterator has its own copy, so an iterator outlives the view it
+// came from, as the one from `v | transform(f) | max_element()` does, and reaches its callable without an indirection
+template <typename F>
+class callable_box {
+public:
+    // iterators are value-initialized and assigned, which lambdas are not
+    constexpr callable_box() = default;
+    constexpr callable_box(const callable_box&) = default;
+    constexpr callable_box(callable_box&&) = default;
+    constexpr callable_box(F f) : m_f(std::move(f)) {
+    }
+
+    constexpr callable_box& operator=(const callable_box& rhs) {
+        if (this != &rhs)
+            assign(rhs.m_f);
+        return *this;
+    }
+    constexpr callable_box& operator=(callable_box&& rhs) {
+        if (this != &rhs)
+            assign(std::move(rhs.m_f));
+        return *this;
+    }
+
+    constexpr F& get() const {
+        return *m_f;
+    }
+
+private:
+    template <typename OptionalT>
+    constexpr void assign(OptionalT&& f) {
+        m_f.reset();
+        if (f)
+            m_f.emplace(*std::forward<OptionalT>(f));
+    }
+
+    mutable std::optional<F> m_f;
+};
+
+template <typename ContainerT, typename F>
+struct filter_view {
+    struct iterator {
+        using base_iterator = iterator_t<ContainerT>;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename std::iterator_traits<base_iterator>::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::iterator_traits<base_iterator>::pointer;
+        using reference = typename std::iterator_traits<base_iterator>::reference;
+
+        base_iterator m_it;
+        base_iterator m_end;
+        callable_box<F> m_f;
+
+        constexpr void satisfy() {
+            while (m_it != m_end && !std::invoke(m_f.get(), *m_it))
+                ++m_it;
+        }
+
+        constexpr reference operator*() const {
+            return *m_it;
+        }
+        constexpr iterator& operator++() {
+            ++m_it;
+            satisfy();
+            return *this;
+        }
+        constexpr iterator operator++(int) {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+        friend constexpr bool operator==(const iterator& lhs, const iterator& rhs) {
+            return lhs.m_it == rhs.m_it;
+        }
+        friend constexpr bool operator!=(const iterator& lhs, const iterator& rhs) {
+            return !(lhs == rhs);
+        }
+    };
+    using value_type = typename iterator::value_type;
+
+    constexpr iterator begin() {
+        using std::begin;
+        using std::end;
+        auto it = iterator{begin(m_container), end(m_container), m_f};
+        it.satisfy();
+        return it;
+    }
+    constexpr iterator end() {
+        using std::end;
+        return iterator{end(m_container), end(m_container), m_f};
+    }
+
+    ContainerT m_container;
+    callable_box<F> m_f;
+};
+
+template <typename ContainerT, typename F>
+struct transform_view {
+    struct iterator {
+        using base_iterator = iterator_t<ContainerT>;
+        // the reference can be a prvalue, which C++17 allows only input iterators, but it is multi-pass and the std
+        // algorithms a view is piped into only ever read *it, as C++20 forward iterators may return by value
+        using iterator_category = std::forward_iterator_tag;
+        using reference = std::invoke_result_t<F&, typename std::iterator_traits<base_iterator>::reference>;
+        using value_type = std::remove_cv_t<std::remove_reference_t<reference>>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+
+        base_iterator m_it;
+        callable_box<F> m_f;
+
+        constexpr reference operator*() const {
+            return std::invoke(m_f.get(), *m_it);
+        }
+        constexpr iterator& operator++() {
+            ++m_it;
+            return *this;
+        }
+        constexpr iterator operator++(int) {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+        friend constexpr bool operator==(const iterator& lhs, const iterator& rhs) {
+            return lhs.m_it == rhs.m_it;
+        }
+        friend constexpr bool operator!=(const iterator& lhs, const iterator& rhs) {
+            return !(lhs == rhs);
+        }
+    };
+    using value_type = typename iterator::value_type;
+
+    constexpr iterator begin() {
+        using std::begin;
+        return iterator{begin(m_container), m_f};
+    }
+    constexpr iterator end() {
+        using std::end;
+        return iterator{end(m_container), m_f};
+    }
+
+    ContainerT m_container;
+    callable_box<F> m_f;
+};
+
+template <typename ContainerT, typename F>
+struct take_while_view {
+    struct iterator {
+        using base_iterator = iterator_t<ContainerT>;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename std::iterator_traits<base_iterator>::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::iterator_traits<base_iterator>::pointer;
+        using reference = typename std::iterator_traits<base_iterator>::reference;
+
+        base_iterator m_it;
+        base_iterator m_end;
+        callable_box<F> m_f;
+        bool m_done;
+
+        constexpr void satisfy() {
+            m_done = m_it == m_end || !std::invoke(m_f.get(), *m_it);
+        }
+
+        constexpr reference operator*() const {
+            return *m_it;
+        }
+        constexpr iterator& operator++() {
+            ++m_it;
+            satisfy();
+            return *this;
+        }
+        constexpr iterator operator++(int) {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+        friend constexpr bool operator==(const iterator& lhs, const iterator& rhs) {
+            return lhs.m_done == rhs.m_done && (lhs.m_done || lhs.m_it == rhs.m_it);
+        }
+        friend constexpr bool operator!=(const iterator& lhs, const iterator& rhs) {
+            return !(lhs == rhs);
+        }
+    };
+    using value_type = typename iterator::value_type;
+
+    constexpr iterator begin() {
+        using std::begin;
+        using std::end;
+        auto it = iterator{begin(m_container), end(m_container), m_f, false};
+        it.satisfy();
+        return it;
+    }
+    constexpr iterator end() {
+        using std::end;
+        return iterator{end(m_container), end(m_container), m_f, true};
+    }
+
+    ContainerT m_container;
+    callable_box<F> m_f;
+};
+
+template <typename ContainerT, typename F>
+struct drop_while_view {
+    using value_type = typename std::iterator_traits<iterator_t<ContainerT>>::value_type;
+
+    constexpr auto begin() {
+        using std::begin;
+        using std::end;
+        return std::find_if_not(begin(m_container), end(m_container), std::ref(m_f));
+    }
+    constexpr auto end() {
+        using std::end;
+        return end(m_container);
+    }
+
+    ContainerT m_container;
+    F m_f;
+};
+
+template <template <typename, typename> typename ViewT, typename F>
+struct view_stage {
+    using mleivo_pipe_ret = std::true_type;
+
+    F m_f;
+
+    // lvalue containers are referenced by the view, rvalue containers (and views) are moved into it. A named stage,
+    // or one in a pipeline, copies its callable into every view, a temporary one moves it in
+    template <typename ContainerT>
+    constexpr auto operator()(ContainerT&& container) const& {
+        return make(*this, std::forward<ContainerT>(container));
+    }
+    template <typename ContainerT>
+    constexpr auto operator()(ContainerT&& container) && {
+        return make(std::move(*this), std::forward<ContainerT>(container));
+    }
+
+private:
+    // a policy bound to the container is bound to the view instead, so `v | par | filter(f) | count()` hands it on to
+    // the terminal stage
+    template <typename SelfT, typename ContainerT>
+    static constexpr auto make(SelfT&& self, ContainerT&& container) {
+        if constexpr (is_morsel_bound_v<ContainerT>) {
+            return make(std::forward<SelfT>(self), std::move(container).run());
+        } else if constexpr (is_policy_bound_v<ContainerT>) {
+            using inner_t = decltype(container.m_container);
+            auto view = make(std::forward<SelfT>(self), static_cast<inner_t&&>(container.m_container));
+            return policy_bound<decltype(view), typename std::decay_t<ContainerT>::policy_type>{std::move(view)};
+        } else {
+            return ViewT<ContainerT, F>{std::forward<ContainerT>(container), std::forward<SelfT>(self).m_f};
+        }
+    }
+};
+
+template <typename ContainerT>
+struct to {
+    template <typename It, typename = std::enable_if_t<!is_execution_policy_v<It>>>
+    static constexpr auto call(It first, It last) {
+        using std::end;
+        auto out = ContainerT{};
+        std::copy(first, last, std::inserter(out, end(out)));
+        return out;
+    }
+
+    // the elements are inserted one after the other whatever the policy, which the views before it have run under
+    template <typename PolicyT, typename It, typename = std::enable_if_t<is_execution_policy_v<PolicyT>>>
+    static constexpr auto call(PolicyT&&, It first, It last) {
+        return call(first, last);
+    }
+};
+} // namespace detail
+
+template <typename F>
+constexpr auto filter(F&& f) {
+    return detail::view_stage<detail::filter_view, std::decay_t<F>>{std::forward<F>(f)};
+}
+
+template <typename F>
+constexpr auto transform(F&& f) {
+    return detail::view_stage<detail::transform_view, std::decay_t<F>>{std::forward<F>(f)};
+}
+
+template <typename F>
+constexpr auto map(F&& f) {
+    return transform(std::forward<F>(f));
+}
+
+template <typename F>
+constexpr auto take_while(F&& f) {
+    return detail::view_stage<detail::take_while_view, std::decay_t<F>>{std::forward<F>(f)};
+}
+
+template <typename F>
+constexpr auto drop_while(F&& f) {
+    return detail::view_stage<detail::drop_while_view, std::decay_t<F>>{std::forward<F>(f)};
+}
+
+// to: materializes a container or view into ContainerT
+template <typename ContainerT>
+constexpr auto to() {
+    return detail::ret_wrapper<detail::to<ContainerT>>{};
+}
+
+// for_each: under a parallel policy, on random access iterators, it runs on exec::thread_pool::global()
+namespace detail {
+struct for_each {
+    // the fewest elements one job takes, otherwise there are a few jobs per worker
+    static constexpr std::size_t grain = 1024;
+
+    // std::for_each takes its callable by value, one that is callable as const goes in by reference instead, so the
+    // state a pipeline's callable holds is not copied on every run
+    template <typename It, typename F>
+    static auto lend(F& f) {
+        if constexpr (std::is_invocable_v<const F&, typename std::iterator_traits<It>::reference>)
+            return std::cref(f);
+        else
+            return f;
+    }
+
+    template <typename It, typename F, typename = std::enable_if_t<!is_execution_policy_v<It>>>
+    static void call(It first, It last, F&& f) {
+        std::for_each(first, last, lend<It>(f));
+    }
+
+    template <typename PolicyT, typename It, typename F, typename = std::enable_if_t<is_execution_policy_v<PolicyT>>>
+    static void call(PolicyT&&, It first, It last, F&& f) {
+        constexpr auto random_access =
+            std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category>;
+        if constexpr (!random_access || std::is_same_v<std::decay_t<PolicyT>, std::execution::sequenced_policy>) {
+            std::for_each(first, last, lend<It>(f));
+        } else {
+            const auto n = static_cast<std::size_t>(last - first);
+            auto& pool = exec::thread_pool::global();
+            const auto piece = std::max<std::size_t>(grain, n / (8 * pool.size()));
+            exec::parallel_for(pool, 0, (n + piece - 1) / piece, [&](std::size_t i) {
+                const auto begin = first + static_cast<std::ptrdiff_t>(i * piece);
+                const auto end = begin + static_cast<std::ptrdiff_t>(std::min(piece, n - i * piece));
+                std::for_each(begin, end, lend<It>(f));
+            });
+        }
+    }
+};
+} // namespace detail
+
+template <typename... Args>
+constexpr decltype(auto) for_each(Args&&... args) {
+    return detail::wrapper<detail::for_each, decltype(args)...>{std::forward<decltype(args)>(args)...};
+}
+
+// morsels: `v | morsels | for_each(f) | replace(a, b) | sort()` queues the element-wise stages after it and, at the
+// next pipeline breaker (sort here), runs all of them on one cache-sized morsel of v before moving to the next, the
+// morsels spread over exec::thread_pool::global(). A pipe that ends in element-wise stages ends in `| run()`, which
+// runs them and returns the container; without it nothing runs. Like under pipes::par, the stages' callables run
+// concurrently on different elements.
+namespace detail {
+template <>
+struct is_elementwise<for_each> : std::true_type {};
+
+// half of L2, leaving the other half to whatever the stages' callables touch
+inline std::size_t morsel_bytes() {
+    static const auto bytes = [] {
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+        if (const auto l2 = sysconf(_SC_LEVEL2_CACHE_SIZE); l2 > 0)
+            return static_cast<std::size_t>(l2) / 2;
+#endif
+        return std::size_t{128} * 1024;
+    }();
+    return bytes;
+}
+
+// nodiscard: a dropped bound is a pipe whose stages never run
+template <typename ContainerT, typename... Stages>
+class [[nodiscard]] morsel_bound {
+public:
+    constexpr morsel_bound(ContainerT&& container, std::tuple<Stages...>&& stages)
+        : m_container(std::forward<ContainerT>(container)), m_stages(std::move(stages)) {
+    }
+
+    morsel_bound(const morsel_bound&) = delete;
+    morsel_bound& operator=(const morsel_bound&) = delete;
+
+    template <typename StageT>
+    morsel_bound<ContainerT, Stages..., StageT> then(StageT&& stage) && {
+        return {std::forward<ContainerT>(m_container),
+                std::tuple_cat(std::move(m_stages), std::tuple<StageT>(std::forward<StageT>(stage)))};
+    }
+
+    // runs the queued stages, the container then goes on to the pipeline breaker
+    ContainerT&& run() && {
+        execute();
+        return std::forward<ContainerT>(m_container);
+    }
+
+private:
+    void execute() {
+        if constexpr (sizeof...(Stages) > 0) {
+            using std::begin;
+            using std::end;
+            auto first = begin(m_container);
+            auto last = end(m_container);
+            using It = decltype(first);
+            if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
+                                            typename std::iterator_traits<It>::iterator_category>) {
+                const auto n = static_cast<std::size_t>(last - first);
+                const auto morsel =
+                    std::max<std::size_t>(1, morsel_bytes() / sizeof(typename std::iterator_traits<It>::value_type));
+                exec::parallel_for(0, (n + morsel - 1) / morsel, [&](std::size_t i) {
+                    const auto begin = first + static_cast<std::ptrdiff_t>(i * morsel);
+                    run_stages(begin, begin + static_cast<std::ptrdiff_t>(std::min(morsel, n - i * morsel)));
+                });
+            } else {
+                run_stages(first, last);
+            }
+        }
+    }
+
+    template <typename It>
+    void run_stages(It first, It last) {
+        std::apply([&](auto&... stage) { (stage.run_on(first, last), ...); }, m_stages);
+    }
+
+    ContainerT m_container;
+    std::tuple<Stages...> m_stages;
+};
+
+struct morsels {
+    using mleivo_pipe_ret = std::true_type;
+
+    template <typename ContainerT>
+    constexpr auto operator()(ContainerT&& container) const {
+        static_assert(!is_policy_bound_v<ContainerT>, "morsels already run in parallel");
+        if constexpr (is_morsel_bound_v<ContainerT>)
+            return (*this)(std::move(container).run());
+        else
+            return morsel_bound<ContainerT>{std::forward<ContainerT>(container), std::tuple<>{}};
+    }
+};
+
+// a container the last stage returns from inside a temporary of an earlier one (the bound of par or morsels) would
+// not outlive the pipe expression, it is moved out while that temporary is still there
+template <typename T>
+constexpr decltype(auto) finish(T&& result) {
+    if constexpr (std::is_rvalue_reference_v<T&&>)
+        return std::remove_reference_t<T>(std::move(result));
+    else
+        return result;
+}
+
+struct run {
+    using mleivo_pipe = std::true_type;
+
+    template <typename ContainerT>
+    constexpr decltype(auto) operator()(ContainerT&& container) const {
+        if constexpr (is_morsel_bound_v<ContainerT>)
+            return finish(std::move(container).run());
+        else
+            return finish(std::forward<ContainerT>(container));
+    }
+};
+} // namespace detail
+
+inline constexpr auto morsels = detail::morsels{};
+
+constexpr auto run() {
+    return detail::run{};
+}
+
+// sort, stable_sort: an optional comparator, and a projection after it, as in sort(std::greater<>{}, &T::id). Under
+// a parallel policy both run a stable parallel merge sort on exec::thread_pool::global(), which needs no TBB
+namespace detail {
+template <typename... Args>
+constexpr auto make_comparator(Args&&... args) {
+    static_assert(sizeof...(Args) <= 2, "sort takes a comparator and a projection");
+    if constexpr (sizeof...(Args) == 0) {
+        return std::less<>{};
+    } else if constexpr (sizeof...(Args) == 1) {
+        return std::get<0>(std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...));
+    } else {
+        auto comp_proj = std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...);
+        return [comp_proj = std::move(comp_proj)](const auto& a, const auto& b) {
+            const auto& [comp, proj] = comp_proj;
+            return std::invoke(comp, std::invoke(proj, a), std::invoke(proj, b));
+        };
+    }
+}
+
+// below this many elements a parallel sort sorts sequentially, and it is the least a parallel leaf sorts or merges
+inline constexpr std::size_t parallel_sort_grain = std::size_t{1} << 14;
+
+// the number of elements of l that the first d elements of a stable merge of l and r take. This is where the merge
+// path, the walk through the merge matrix, crosses the diagonal d, so merges split on it are independent
+template <typename It, typename Compare>
+std::size_t merge_path(It l, std::size_t nl, It r, std::size_t nr, std::size_t d, Compare& comp) {
+    auto lo = d > nr ? d - nr : 0;
+    auto hi = std::min(d, nl);
+    while (lo < hi) {
+        const auto i = lo + (hi - lo) / 2;
+        const auto j = d - i;
+        // l[i] still precedes r[j - 1], so the first d take more of l
+        if (!comp(r[static_cast<std::ptrdiff_t>(j - 1)], l[static_cast<std::ptrdiff_t>(i)]))
+            lo = i + 1;
+        else
+            hi = i;
+    }
+    return lo;
+}
+
+template <typename It, typename OutIt, typename Compare>
+void parallel_merge(exec::thread_pool& pool, It l, std::size_t nl, It r, std::size_t nr, OutIt out, Compare& comp) {
+    const auto n = nl + nr;
+    if (n <= 2 * parallel_sort_grain) {
+        std::merge(std::make_move_iterator(l), std::make_move_iterator(l + static_cast<std::ptrdiff_t>(nl)),
+                   std::make_move_iterator(r), std::make_move_iterator(r + static_cast<std::ptrdiff_t>(nr)), out, comp);
+        return;
+    }
+    const auto d = n / 2;
+    const auto i = merge_path(l, nl, r, nr, d, comp);
+    const auto j = d - i;
+    pool.fork_join([&] { parallel_merge(pool, l, i, r, j, out, comp); },
+                   [&] {
+                       parallel_merge(pool, l + static_cast<std::ptrdiff_t>(i), nl - i,
+                                      r + static_cast<std::ptrdiff_t>(j), nr - j, out + static_cast<std::ptrdiff_t>(d),
+                                      comp);
+                   });
+}
+
+// sorts [from, from + n) into to when Into, in place otherwise, with the other range as the scratch space. The halves
+// are sorted into the range they are merged from, so no pass only copies
+template <bool Into, typename ItA, typename ItB, typename Compare>
+void parallel_merge_sort(exec::thread_pool& pool, ItA from, ItB to, std::size_t n, std::size_t leaf, Compare& comp) {
+    if (n <= leaf) {
+        std::stable_sort(from, from + static_cast<std::ptrdiff_t>(n), comp);
+        if constexpr (Into)
+            std::move(from, from + static_cast<std::ptrdiff_t>(n), to);
+        return;
+    }
+    const auto half = static_cast<std::ptrdiff_t>(n / 2);
+    pool.fork_join([&] { parallel_merge_sort<!Into>(pool, from, to, n / 2, leaf, comp); },
+                   [&] { parallel_merge_sort<!Into>(pool, from + half, to + half, n - n / 2, leaf, comp); });
+    if constexpr (Into)
+        parallel_merge(pool, from, n / 2, from + half, n - n / 2, to, comp);
+    else
+        parallel_merge(pool, to, n / 2, to + half, n - n / 2, from, comp);
+}
+
+template <bool Stable, typename It, typename Compare>
+void sequential_sort(It first, It last, Compare& comp) {
+    if constexpr (Stable)
+        std::stable_sort(first, last, comp);
+    else
+        std::sort(first, last, comp);
+}
+
+// the elements move to a buffer and are merge sorted back from there, with a few leaves per worker
+template <bool Stable, typename It, typename Compare>
+void parallel_sort(exec::thread_pool& pool, It first, It last, Compare& comp) {
+    const auto n = static_cast<std::size_t>(std::distance(first, last));
+    if (n < 2 * parallel_sort_grain || pool.size() < 2) {
+        sequential_sort<Stable>(first, last, comp);
+        return;
+    }
+    auto buffer = std::vector<typename std::iterator_traits<It>::value_type>(std::make_move_iterator(first),
+                                                                           std::make_move_iterator(last));
+    const auto leaf = std::max(parallel_sort_grain, n / (4 * pool.size()));
+    pool.run([&] { parallel_merge_sort<true>(pool, buffer.begin(), first, n, leaf, comp); });
+}
+
+template <bool Stable>
+struct sort {
+    template <typename It, typename... Args, typename = std::enable_if_t<!is_execution_policy_v<It>>>
+    static void call(It first, It last, Args&&... args) {
+        auto comp = make_comparator(std::forward<Args>(args)...);
+        sequential_sort<Stable>(first, last, comp);
+    }
+
+    template <typename PolicyT, typename It, typename... Args,
+              typename = std::enable_if_t<is_execution_policy_v<PolicyT>>>
+    static void call(PolicyT&&, It first, It last, Args&&... args) {
+        auto comp = make_comparator(std::forward<Args>(args)...);
+        if constexpr (std::is_same_v<std::decay_t<PolicyT>, std::execution::sequenced_policy>)
+            sequential_sort<Stable>(first, last, comp);
+        else
+            parallel_sort<Stable>(exec::thread_pool::global(), first, last, comp);
+    }
+};
+} // namespace detail
+
+template <typename... Args>
+constexpr decltype(auto) sort(Args&&... args) {
+    return detail::wrapper<detail::sort<false>, decltype(args)...>{std::forward<decltype(args)>(args)...};
+}
+
+template <typename... Args>
+constexpr decltype(auto) stable_sort(Args&&... args) {
+    return detail::wrapper<detail::sort<true>, decltype(args)...>{std::forward<decltype(args)>(args)...};
+}
+
+// radix_sort: a stable LSD radix sort on key(element), or on the elements themselves without a key
+namespace detail {
+struct radix_identity {
+    template <typename T>
+    constexpr T&& operator()(T&& t) const noexcept {
+        return std::forward<T>(t);
+    }
+};
+
+// encode maps a key to an unsigned radix key with the same order, decode maps it back
+template <typename T, typename = void>
+struct radix_traits {
+    static_assert(sizeof(T) == 0, "radix_sort keys are integers, enums, floating point or std::array of chars");
+};
+
+template <typename T>
+struct radix_traits<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+    using key_type = std::make_unsigned_t<T>;
+    // signed keys have their sign bit flipped, so negatives sort below positives
+    static constexpr key_type flip = std::is_signed_v<T> ? key_type(key_type{1} << (sizeof(T) * 8 - 1)) : key_type{0};
+
+    static constexpr key_type encode(T t) {
+        return static_cast<key_type>(static_cast<key_type>(t) ^ flip);
+    }
+    static constexpr T decode(key_type k) {
+        return static_cast<T>(static_cast<key_type>(k ^ flip));
+    }
+};
+
+template <typename T>
+struct radix_traits<T, std::enable_if_t<std::is_enum_v<T>>> {
+    using underlying = radix_traits<std::underlying_type_t<T>>;
+    using key_type = typename underlying::key_type;
+
+    static constexpr key_type encode(T t) {
+        return underlying::encode(static_cast<std::underlying_type_t<T>>(t));
+    }
+    static constexpr T decode(key_type k) {
+        return static_cast<T>(underlying::decode(k));
+    }
+};
+
+// negative floats have all bits flipped, their magnitude sorts backwards, and positives only the sign bit. -0.0 sorts
+// below 0.0 and NaNs at the end of their sign
+template <typename T>
+struct radix_traits<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    static_assert(std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8));
+    using key_type = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+    static constexpr key_type sign = key_type{1} << (sizeof(T) * 8 - 1);
+
+    static key_type encode(T t) {
+        auto k = key_type{};
+        std::memcpy(&k, &t, sizeof(T));
+        return k & sign ? ~k : k | sign;
+    }
+    static T decode(key_type k) {
+        k = k & sign ? k & ~sign : ~k;
+        auto t = T{};
+        std::memcpy(&t, &k, sizeof(T));
+        return t;
+    }
+};
+
+// fixed-width strings compare like std::string, byte by byte as unsigned char
+template <typename C, std::size_t N>
+struct radix_traits<std::array<C, N>, std::enable_if_t<sizeof(C) == 1>> {
+    using key_type = std::array<unsigned char, N>;
+
+    static constexpr key_type encode(const std::array<C, N>& t) {
+        auto k = key_type{};
+        for (std::size_t i = 0; i < N; ++i)
+            k[i] = static_cast<unsigned char>(t[i]);
+        return k;
+    }
+};
+
+// the digits of a radix key, least significant first: DigitBits wide for integers, a byte for strings
+template <unsigned DigitBits, typename K>
+struct radix_digits {
+    static constexpr unsigned bits = std::min<unsigned>(DigitBits, sizeof(K) * 8);
+    static constexpr std::size_t passes = (sizeof(K) * 8 + bits - 1) / bits;
+    static constexpr std::size_t radix = std::size_t{1} << bits;
+
+    static constexpr std::size_t digit(K k, std::size_t pass) {
+        return static_cast<std::size_t>(k >> (pass * bits)) & (radix - 1);
+    }
+};
+
+template <unsigned DigitBits, std::size_t N>
+struct radix_digits<DigitBits, std::array<unsigned char, N>> {
+    static constexpr std::size_t passes = N;
+    static constexpr std::size_t radix = 256;
+
+    static constexpr std::size_t digit(const std::array<unsigned char, N>& k, std::size_t pass) {
+        return k[N - 1 - pass];
+    }
+};
+
+template <unsigned DigitBits>
+struct radix_sort {
+    static_assert(DigitBits == 8 || DigitBits == 11 || DigitBits == 16, "radix_sort digits are 8, 11 or 16 bits");
+
+    template <typename It, typename... KeyT, typename = std::enable_if_t<!is_execution_policy_v<It>>>
+    static void call(It first, It last, KeyT&&... key) {
+        static_assert(sizeof...(KeyT) <= 1, "radix_sort takes one key projection");
+        sort(std::execution::seq, first, last, key..., radix_identity{});
+    }
+
+    template <typename PolicyT, typename It, typename... KeyT,
+              typename = std::enable_if_t<is_execution_policy_v<PolicyT>>>
+    static void call(PolicyT&& policy, It first, It last, KeyT&&... key) {
+        static_assert(sizeof...(KeyT) <= 1, "radix_sort takes one key projection");
+        sort(std_policy(policy), first, last, key..., radix_identity{});
+    }
+
+private:
+    // a sequenced sort is one chunk. A parallel one has a few chunks per thread, each with its own histogram, so that
+    // the chunks scatter their elements independently and stay in order. A chunk has at least min_chunk elements and
+    // four per entry of its histogram, which keeps the histograms of wide digits a fraction of the input
+    static constexpr std::size_t min_chunk = std::size_t{1} << 16;
+
+    template <typename PolicyT, typename DigitsT>
+    static std::size_t chunk_count(std::size_t n) {
+        constexpr auto chunk = std::max(min_chunk, 4 * DigitsT::passes * DigitsT::radix);
+        if constexpr (std::is_same_v<PolicyT, std::execution::sequenced_policy>)
+            return 1;
+        else
+            return std::clamp<std::size_t>(n / chunk, 1, 4 * exec::thread_pool::global().size());
+    }
+
+    template <typename PolicyT, typename F>
+    static void for_each_chunk(const PolicyT&, std::size_t chunks, F&& f) {
+        if (chunks == 1)
+            f(std::size_t{0});
+        else
+            exec::parallel_for(0, chunks, f);
+    }
+
+    // the radix key of an element and where the element was before the sort
+    template <typename K>
+    struct entry {
+        K key;
+        std::size_t index;
+    };
+
+    template <typename PolicyT, typename It, typename KeyF, typename... Unused>
+    static void sort(const PolicyT& policy, It first, It last, KeyF&& key, Unused&&...) {
+        using T = typename std::iterator_traits<It>::value_type;
+        using traits = radix_traits<std::decay_t<std::invoke_result_t<KeyF&, const T&>>>;
+        using K = typename traits::key_type;
+        using digits = radix_digits<DigitBits, K>;
+        // arithmetic elements sorted by themselves are rebuilt from their sorted keys. Others are sorted as entries,
+        // their key and index, and then moved once into place, so the passes move no elements
+        constexpr bool keys_only = std::is_same_v<std::decay_t<KeyF>, radix_identity> && std::is_arithmetic_v<T>;
+        using E = std::conditional_t<keys_only, K, entry<K>>;
+        const auto key_of = [](const E& e) -> const K& {
+            if constexpr (keys_only)
+                return e;
+            else
+                return e.key;
+        };
+        constexpr auto passes = digits::passes;
+        constexpr auto radix = digits::radix;
+
+        const auto n = static_cast<std::size_t>(std::distance(first, last));
+        if (n < 2)
+            return;
+        const auto chunks = chunk_count<PolicyT, digits>(n);
+        const auto chunk_begin = [n, chunks](std::size_t c) { return c * n / chunks; };
+
+        // default initialized, every entry is written before it is read
+        auto entries = std::unique_ptr<E[]>(new E[n]);
+        auto entries_tmp = std::unique_ptr<E[]>(new E[n]);
+        // counts[(c * passes + p) * radix + d]: the keys of chunk c with digit d in pass p, every pass in one read
+        auto counts = std::vector<std::size_t>(chunks * passes * radix);
+        for_each_chunk(policy, chunks, [&](std::size_t c) {
+            auto* count = counts.data() + c * passes * radix;
+            for (auto i = chunk_begin(c), chunk_end = chunk_begin(c + 1); i < chunk_end; ++i) {
+                const auto k = traits::encode(std::invoke(key, first[static_cast<std::ptrdiff_t>(i)]));
+                if constexpr (keys_only)
+                    entries[i] = k;
+                else
+                    entries[i] = E{k, i};
+                for (std::size_t p = 0; p < passes; ++p)
+                    ++count[p * radix + digits::digit(k, p)];
+            }
+        });
+        const auto total = [&](std::size_t p, std::size_t d) {
+            auto sum = std::size_t{0};
+            for (std::size_t c = 0; c < chunks; ++c)
+                sum += counts[(c * passes + p) * radix + d];
+            return sum;
+        };
+
+        // a digit shared by every key leaves the order as it is, its pass is skipped
+        auto last_pass = passes;
+        for (std::size_t p = 0; p < passes; ++p) {
+            if (total(p, digits::digit(key_of(entries[0]), p)) != n)
+                last_pass = p;
+        }
+        if (last_pass == passes)
+            return;
+
+        // the last pass scatters the elements, moved out to a buffer, or the decoded keys straight into place
+        auto buffer = keys_only ? std::vector<T>{}
+                                : std::vector<T>(std::make_move_iterator(first), std::make_move_iterator(last));
+        auto offsets = std::vector<std::size_t>(chunks * radix);
+        auto sorted_passes = std::size_t{0};
+        for (std::size_t p = 0; p <= last_pass; ++p) {
+            if (total(p, digits::digit(key_of(entries[0]), p)) == n)
+                continue;
+            // the chunks' counts are of the order before the first pass, later passes recount them
+            if (sorted_passes > 0 && chunks > 1) {
+                for_each_chunk(policy, chunks, [&](std::size_t c) {
+                    auto* count = counts.data() + (c * passes + p) * radix;
+                    std::fill(count, count + radix, std::size_t{0});
+                    for (auto i = chunk_begin(c), chunk_end = chunk_begin(c + 1); i < chunk_end; ++i)
+                        ++count[digits::digit(key_of(entries[i]), p)];
+                });
+            }
+            auto offset = std::size_t{0};
+            for (std::size_t d = 0; d < radix; ++d) {
+                for (std::size_t c = 0; c < chunks; ++c) {
+                    offsets[c * radix + d] = offset;
+                    offset += counts[(c * passes + p) * radix + d];
+                }
+            }
+            for_each_chunk(policy, chunks, [&](std::size_t c) {
+                auto* offset = offsets.data() + c * radix;
+                const auto* in = entries.get();
+                auto* out = entries_tmp.get();
+                const auto chunk_end = chunk_begin(c + 1);
+                if (p < last_pass) {
+                    for (auto i = chunk_begin(c); i < chunk_end; ++i)
+                        out[offset[digits::digit(key_of(in[i]), p)]++] = in[i];
+                } else {
+                    for (auto i = chunk_begin(c); i < chunk_end; ++i) {
+                        const auto j = static_cast<std::ptrdiff_t>(offset[digits::digit(key_of(in[i]), p)]++);
+                        if constexpr (keys_only)
+                            first[j] = traits::decode(in[i]);
+                        else
+                            first[j] = std::move(buffer[in[i].index]);
+                    }
+                }
+            });
+            entries.swap(entries_tmp);
+            ++sorted_passes;
+        }
+    }
+};
+} // namespace detail
+
+// keys are integers, enums, floating point or fixed-width strings as std::array of chars. DigitBits, 8, 11 or 16,
+// trades the passes over the elements against the size of the histograms, and a pass whose digit is the same for every
+// key is skipped. After `| pipes::par` the histograms and the scatters run in parallel over chunks of the elements
+template <unsigned DigitBits = 8, typename... Args>
+constexpr decltype(auto) radix_sort(Args&&... args) {
+    return detail::wrapper<detail::radix_sort<DigitBits>, decltype(args)...>{std::forward<decltype(args)>(args)...};
+}
+
+// sum: the elements' value_type summed in independent lanes, one cache line of them, which the compiler keeps in
+// vector registers where std::accumulate's single chain of floating point additions cannot be reordered.
+//   summation::fast      the lanes, joined in a tree at the end
+//   summation::pairwise  halves summed recursively down to blocks of the lanes, the error grows with log n
+//   summation::neumaier  every lane compensated (Kahan-Babuska-Neumaier), about as exact as the type allows
+// After `| pipes::par` (random access iterators) the range is split in halves down to pieces of sum_grain elements,
+// summed on exec::thread_pool::global() and joined in the same tree whatever the number of threads, so the result
+// depends on the input alone. pairwise gives the same result with or without a policy. Integers are summed in the
+// lanes in every mode, those narrower than int as int, as std::accumulate(first, last, 0) would. Other value types,
+// std::string or std::complex, are added left to right as std::accumulate(first, last, T{}) does, in every mode and
+// with any policy, since their + need not be commutative
+enum class summation { fast, pairwise, neumaier };
+
+// a kernel the vectorizer handles on its own can lose that when it is inlined into a larger function
+#if defined(__GNUC__)
+#define MLEIVO_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define MLEIVO_NOINLINE __declspec(noinline)
+#else
+#define MLEIVO_NOINLINE
+#endif
+
+namespace detail {
+// the type sum adds the elements in and returns: a byte buffer sums past 255
+template <typename V, typename = void>
+struct sum_type {
+    using type = V;
+};
+
+template <typename V>
+struct sum_type<V, std::enable_if_t<std::is_integral_v<V>>> {
+    using type = std::common_type_t<V, int>;
+};
+
+template <typename T>
+struct compensated {
+    T sum{};
+    T error{};
+
+    constexpr void add(T x) {
+        const auto t = sum + x;
+        error += std::abs(sum) >= std::abs(x) ? (sum - t) + x : (x - t) + sum;
+        sum = t;
+    }
+
+    constexpr compensated& operator+=(const compensated& rhs) {
+        add(rhs.sum);
+        error += rhs.error;
+        return *this;
+    }
+
+    constexpr T value() const {
+        return sum + error;
+    }
+};
+
+struct sum {
+    static constexpr std::size_t sum_grain = std::size_t{1} << 16;
+    static constexpr std::size_t pairwise_block = 1024;
+
+    template <typename It, typename = std::enable_if_t<!is_execution_policy_v<It>>>
+    static auto call(It first, It last, summation mode = summation::fast) {
+        using V = typename std::iterator_traits<It>::value_type;
+        using T = typename sum_type<V>::type;
+        if constexpr (!std::is_arithmetic_v<V>) {
+            return std::accumulate(first, last, T{});
+        } else if constexpr (!std::is_floating_point_v<T>) {
+            return lanes<T>(first, last);
+        } else {
+            switch (mode) {
+            case summation::pairwise:
+                if constexpr (is_random_access<It>)
+                    return pairwise<T>(first, last);
+                else
+                    return lanes<T>(first, last);
+            case summation::neumaier:
+                return compensated_lanes<T>(first, last).value();
+            default:
+                return lanes<T>(first, last);
+            }
+        }
+    }
+
+    template <typename PolicyT, typename It, typename = std::enable_if_t<is_execution_policy_v<PolicyT>>>
+    static auto call(PolicyT&&, It first, It last, summation mode = summation::fast) {
+        if constexpr (!is_random_access<It> || std::is_same_v<std::decay_t<PolicyT>, std::execution::sequenced_policy>
+                      || !std::is_arithmetic_v<typename std::iterator_traits<It>::value_type>)
+            return call(first, last, mode);
+        else
+            return parallel(exec::thread_pool::global(), first, last, mode);
+    }
+
+    template <typename It>
+    static auto parallel(exec::thread_pool& pool, It first, It last, summation mode) {
+        using V = typename std::iterator_traits<It>::value_type;
+        static_assert(std::is_arithmetic_v<V>, "a parallel sum reorders the additions, only for arithmetic types");
+        using T = typename sum_type<V>::type;
+        const auto n = static_cast<std::size_t>(last - first);
+        const auto at = [first](std::size_t i) { return first + static_cast<std::ptrdiff_t>(i); };
+        if constexpr (!std::is_floating_point_v<T>) {
+            mode = summation::fast;
+        } else if (mode == summation::neumaier) {
+            const auto piece = [&](std::size_t b, std::size_t e, compensated<T>) {
+                return compensated_lanes<T>(at(b), at(e));
+            };
+            const auto join = [](compensated<T> lhs, const compensated<T>& rhs) { return lhs += rhs; };
+            return exec::parallel_reduce(pool, 0, n, compensated<T>{}, piece, join, sum_grain).value();
+        }
+        // the pieces are halves, as pairwise's blocks are, so both build the same tree
+        const auto piece = [&](std::size_t b, std::size_t e, T) {
+            return mode == summation::pairwise ? pairwise<T>(at(b), at(e)) : lanes<T>(at(b), at(e));
+        };
+        return exec::parallel_reduce(pool, 0, n, T{}, piece, std::plus<>{}, sum_grain);
+    }
+
+private:
+    template <typename It>
+    static constexpr bool is_random_access =
+        std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category>;
+
+    template <typename T>
+    static constexpr std::size_t lane_count = std::max<std::size_t>(4, 64 / sizeof(T));
+
+    // lane j takes the elements at j modulo the lane count, the lanes then join in halves
+    template <typename T, typename It>
+    static T lanes(It first, It last) {
+        constexpr auto L = lane_count<T>;
+        T acc[L] = {};
+        if constexpr (is_random_access<It>) {
+            const auto n = static_cast<std::size_t>(last - first);
+            std::size_t i = 0;
+            for (; i + L <= n; i += L) {
+                for (std::size_t j = 0; j < L; ++j)
+                    acc[j] += first[static_cast<std::ptrdiff_t>(i + j)];
+            }
+            for (std::size_t j = 0; i < n; ++i, ++j)
+                acc[j] += first[static_cast<std::ptrdiff_t>(i)];
+        } else {
+            for (std::size_t j = 0; first != last; ++first, j = (j + 1) % L)
+                acc[j] += *first;
+        }
+        for (auto width = L / 2; width > 0; width /= 2) {
+            for (std::size_t j = 0; j < width; ++j)
+                acc[j] += acc[j + width];
+        }
+        return acc[0];
+    }
+
+    template <typename T, typename It>
+    static T pairwise(It first, It last) {
+        const auto n = static_cast<std::size_t>(last - first);
+        if (n <= pairwise_block)
+            return lanes<T>(first, last);
+        const auto mid = first + static_cast<std::ptrdiff_t>(n / 2);
+        return pairwise<T>(first, mid) + pairwise<T>(mid, last);
+    }
+
+    // Knuth's two-sum finds the same rounding error as Neumaier's comparison does, without a branch to vectorize
+    template <typename T>
+    static void two_sum(T& sum, T& error, T x) {
+        const auto t = sum + x;
+        const auto z = t - sum;
+        error += (sum - (t - z)) + (x - z);
+        sum = t;
+    }
+
+    // the error goes back into the sum, where it is small enough not to, a fast two-sum keeps what is left of it
+    template <typename T>
+    static void renormalize(T& sum, T& error) {
+        const auto t = sum + error;
+        error -= t - sum;
+        sum = t;
+    }
+
+    template <typename T, typename It>
+    MLEIVO_NOINLINE static compensated<T> compensated_lanes(It first, It last) {
+        // half the lanes, a lane here holds a sum and its error, and both stay in registers
+        constexpr auto L = lane_count<T> / 2;
+        // now and then the errors go back into their sums, an error left to grow loses its own low bits
+        constexpr std::size_t rounds = 64;
+        T sums[L] = {};
+        T errors[L] = {};
+        if constexpr (is_random_access<It>) {
+            const auto n = static_cast<std::size_t>(last - first);
+            std::size_t i = 0;
+            while (i + L <= n) {
+                const auto end = i + std::min((n - i) / L, rounds) * L;
+                for (; i < end; i += L) {
+                    // two_sum a step at a time over all the lanes, as the compiler's vectorizer wants it
+                    T x[L];
+                    T t[L];
+                    T z[L];
+                    for (std::size_t j = 0; j < L; ++j)
+                        x[j] = first[static_cast<std::ptrdiff_t>(i + j)];
+                    for (std::size_t j = 0; j < L; ++j)
+                        t[j] = sums[j] + x[j];
+                    for (std::size_t j = 0; j < L; ++j)
+                        z[j] = t[j] - sums[j];
+                    for (std::size_t j = 0; j < L; ++j)
+                        errors[j] += (sums[j] - (t[j] - z[j])) + (x[j] - z[j]);
+                    for (std::size_t j = 0; j < L; ++j)
+                        sums[j] = t[j];
+                }
+                for (std::size_t j = 0; j < L; ++j)
+                    renormalize(sums[j], errors[j]);
+            }
+            for (std::size_t j = 0; i < n; ++i, ++j)
+                two_sum(sums[j], errors[j], T(first[static_cast<std::ptrdiff_t>(i)]));
+        } else {
+            for (std::size_t i = 0; first != last; ++first, ++i) {
+                two_sum(sums[i % L], errors[i % L], T(*first));
+                if ((i + 1) % (rounds * L) == 0) {
+                    for (std::size_t j = 0; j < L; ++j)
+                        renormalize(sums[j], errors[j]);
+                }
+            }
+        }
+        auto out = compensated<T>{};
+        for (std::size_t j = 0; j < L; ++j)
+            out += compensated<T>{sums[j], errors[j]};
+        return out;
+    }
+};
+} // namespace detail
+
+template <typename... Args>
+constexpr auto sum(Args&&... args) {
+    return detail::ret_wrapper<detail::sum, decltype(args)...>(std::forward<decltype(args)>(args)...);
+}
+
 #define MLEIVO_STL_WRAPPER(FUNCTION_NAME)                                                                              \
     namespace detail {                                                                                                 \
     struct FUNCTION_NAME {                                                                                             \
@@ -97,25 +1373,197 @@ struct ret_wrapper {
         return detail::ret_wrapper<detail::FUNCTION_NAME, decltype(args)...>(std::forward<decltype(args)>(args)...);   \
     }
 
-MLEIVO_STL_WRAPPER(for_each)
+#define MLEIVO_STL_WRAPPER_AT(FUNCTION_NAME)                                                                           \
+    namespace detail {                                                                                                 \
+    struct FUNCTION_NAME {                                                                                             \
+        template <typename It, typename... Args>                                                                       \
+        static constexpr std::enable_if_t<!is_execution_policy_v<It>>                                                  \
+        call(It first, It last, typename std::iterator_traits<It>::difference_type n, Args&&... args) {                \
+            std::FUNCTION_NAME(first, std::next(first, n), last, std::forward<decltype(args)>(args)...);               \
+        }                                                                                                              \
+                                                                                                                       \
+        template <typename PolicyT, typename It, typename... Args>                                                     \
+        static std::enable_if_t<is_execution_policy_v<PolicyT>>                                                        \
+        call(PolicyT&& policy, It first, It last, typename std::iterator_traits<It>::difference_type n,                \
+             Args&&... args) {                                                                                         \
+            std::FUNCTION_NAME(std::forward<PolicyT>(policy), first, std::next(first, n), last,                        \
+                               std::forward<decltype(args)>(args)...);                                                 \
+        }                                                                                                              \
+    };                                                                                                                 \
+    }                                                                                                                  \
+                                                                                                                       \
+    template <typename... Args>                                                                                        \
+    constexpr decltype(auto) FUNCTION_NAME(Args&&... args) {                                                           \
+        return detail::wrapper<detail::FUNCTION_NAME, decltype(args)...>{std::forward<decltype(args)>(args)...};       \
+    };
+
+#define MLEIVO_STL_WRAPPER_INPLACE(FUNCTION_NAME)                                                                      \
+    namespace detail {                                                                                                 \
+    struct FUNCTION_NAME {                                                                                             \
+        template <typename It, typename... Args>                                                                       \
+        static constexpr std::enable_if_t<!is_execution_policy_v<It>> call(It first, It last, Args&&... args) {        \
+            std::FUNCTION_NAME(first, last, first, std::forward<decltype(args)>(args)...);                             \
+        }                                                                                                              \
+                                                                                                                       \
+        template <typename PolicyT, typename It, typename... Args>                                                     \
+        static std::enable_if_t<is_execution_policy_v<PolicyT>> call(PolicyT&& policy, It first, It last,              \
+                                                                     Args&&... args) {                                 \
+            std::FUNCTION_NAME(std::forward<PolicyT>(policy), first, last, first,                                      \
+                               std::forward<decltype(args)>(args)...);                                                 \
+        }                                                                                                              \
+    };                                                                                                                 \
+    }                                                                                                                  \
+                                                                                                                       \
+    template <typename... Args>                                                                                        \
+    constexpr decltype(auto) FUNCTION_NAME(Args&&... args) {                                                           \
+        return detail::wrapper<detail::FUNCTION_NAME, decltype(args)...>{std::forward<decltype(args)>(args)...};       \
+    };
+
+MLEIVO_STL_WRAPPER(fill)
+MLEIVO_STL_WRAPPER(partition)
+MLEIVO_STL_WRAPPER(replace)
+MLEIVO_STL_WRAPPER(replace_if)
 MLEIVO_STL_WRAPPER(reverse)
-MLEIVO_STL_WRAPPER(sort)
+MLEIVO_STL_WRAPPER(stable_partition)
+
+MLEIVO_STL_WRAPPER_AT(nth_element)
+MLEIVO_STL_WRAPPER_AT(partial_sort)
+
+MLEIVO_STL_WRAPPER_INPLACE(inclusive_scan)
 
+MLEIVO_STL_WRAPPER_RET(all_of)
+MLEIVO_STL_WRAPPER_RET(any_of)
+MLEIVO_STL_WRAPPER_RET(count)
+MLEIVO_STL_WRAPPER_RET(count_if)
+MLEIVO_STL_WRAPPER_RET(find)
+MLEIVO_STL_WRAPPER_RET(find_if)
+MLEIVO_STL_WRAPPER_RET(is_sorted)
 MLEIVO_STL_WRAPPER_RET(max_element)
-MLEIVO_STL_WRAPPER_RET(accumulate)
+MLEIVO_STL_WRAPPER_RET(min_element)
+MLEIVO_STL_WRAPPER_RET(minmax_element)
+MLEIVO_STL_WRAPPER_RET(none_of)
+MLEIVO_STL_WRAPPER_RET(reduce)
+MLEIVO_STL_WRAPPER_RET(transform_reduce)
+
+namespace detail {
+template <>
+struct is_elementwise<fill> : std::true_type {};
+
+template <>
+struct is_elementwise<replace> : std::true_type {};
+
+template <>
+struct is_elementwise<replace_if> : std::true_type {};
+} // namespace detail
+
+// pipelines: stages piped into each other, `auto p = for_each(f) | sort() | accumulate(0)`, compose into one stage
+// that owns copies of their arguments. `batch | p` then runs the stages without copying or moving what they hold, so a
+// pipeline built once serves any number of batches, from any number of threads when its callables allow that
+namespace detail {
+template <typename T>
+struct is_stage : std::false_type {};
+
+template <typename CallT, typename... Args>
+struct is_stage<wrapper<CallT, Args...>> : std::true_type {};
+
+template <typename CallT, typename... Args>
+struct is_stage<ret_wrapper<CallT, Args...>> : std::true_type {};
+
+template <template <typename, typename> class ViewT, typename F>
+struct is_stage<view_stage<ViewT, F>> : std::true_type {};
+
+template <typename PolicyT>
+struct is_stage<execution<PolicyT>> : std::true_type {};
+
+template <>
+struct is_stage<morsels> : std::true_type {};
+
+template <>
+struct is_stage<run> : std::true_type {};
+
+template <typename... Stages>
+struct pipeline;
+
+template <typename... Stages>
+struct is_stage<pipeline<Stages...>> : std::true_type {};
+
+template <typename T>
+struct is_pipeline : std::false_type {};
+
+template <typename... Stages>
+struct is_pipeline<pipeline<Stages...>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_stage_v = is_stage<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+template <typename... Stages>
+struct pipeline {
+    using mleivo_pipe = std::true_type;
+
+    std::tuple<Stages...> m_stages;
+
+    template <typename ContainerT>
+    constexpr decltype(auto) operator()(ContainerT&& container) const {
+        return apply<0>(std::forward<ContainerT>(container));
+    }
+
+private:
+    // the end of a pipeline is a pipeline breaker: morsels queued in it run before it returns
+    template <std::size_t I, typename ContainerT>
+    constexpr decltype(auto) apply(ContainerT&& container) const {
+        const auto& stage = std::get<I>(m_stages);
+        if constexpr (I + 1 < sizeof...(Stages))
+            return apply<I + 1>(stage(std::forward<ContainerT>(container)));
+        else if constexpr (is_morsel_bound_v<decltype(stage(std::forward<ContainerT>(container)))>)
+            return finish(stage(std::forward<ContainerT>(container)).run());
+        else
+            return finish(stage(std::forward<ContainerT>(container)));
+    }
+};
+
+// the stages a pipeline is made of, copied from a named stage and moved from a temporary one
+template <typename StageT>
+constexpr auto owned_stages(StageT&& stage) {
+    using stage_t = std::remove_cv_t<std::remove_reference_t<StageT>>;
+    if constexpr (is_pipeline<stage_t>::value)
+        return std::forward<StageT>(stage).m_stages;
+    else
+        return std::tuple<stage_t>{std::forward<StageT>(stage)};
+}
+
+template <typename... Stages>
+constexpr auto make_pipeline(std::tuple<Stages...>&& stages) {
+    return pipeline<Stages...>{std::move(stages)};
+}
+
+template <typename LhsT, typename RhsT>
+constexpr auto compose(LhsT&& lhs, RhsT&& rhs) {
+    return make_pipeline(
+        std::tuple_cat(owned_stages(std::forward<LhsT>(lhs)), owned_stages(std::forward<RhsT>(rhs))));
+}
+} // namespace detail
 
 #undef MLEIVO_STL_WRAPPER
+#undef MLEIVO_STL_WRAPPER_AT
+#undef MLEIVO_STL_WRAPPER_INPLACE
 #undef MLEIVO_STL_WRAPPER_RET
+#undef MLEIVO_NOINLINE
 } // namespace mleivo::pipes
 
 template <typename ContainerT, typename CallablePipeT,
           typename = typename std::remove_cv_t<std::remove_reference_t<CallablePipeT>>::mleivo_pipe>
 decltype(auto) constexpr operator|(ContainerT&& container, CallablePipeT&& f) {
-    return f(std::forward<ContainerT>(container));
+    if constexpr (mleivo::pipes::detail::is_stage_v<ContainerT>)
+        return mleivo::pipes::detail::compose(std::forward<ContainerT>(container), std::forward<CallablePipeT>(f));
+    else
+        return std::forward<CallablePipeT>(f)(std::forward<ContainerT>(container));
 }
 
 template <typename ContainerT, typename CallablePipeT,
           typename = typename std::remove_cv_t<std::remove_reference_t<CallablePipeT>>::mleivo_pipe_ret>
 auto constexpr operator|(ContainerT&& container, CallablePipeT&& f) {
-    return f(std::forward<ContainerT>(container));
+    if constexpr (mleivo::pipes::detail::is_stage_v<ContainerT>)
+        return mleivo::pipes::detail::compose(std::forward<ContainerT>(container), std::forward<CallablePipeT>(f));
+    else
+        return std::forward<CallablePipeT>(f)(std::forward<ContainerT>(container));
 }
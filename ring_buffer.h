@@ -0,0 +1,491 @@
+/*
+ * Copyright 2023 Marcus Leivo
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "span.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace mleivo::cu {
+namespace detail {
+// a separate line for each index keeps the producer and the consumer from invalidating each other's cache
+inline constexpr std::size_t cache_line_size = 64;
+
+constexpr std::size_t ceil_pow2(std::size_t n) {
+    auto out = std::size_t{1};
+    while (out < n)
+        out <<= 1;
+    return out;
+}
+
+// position m_pos counts from the start of the storage and wraps with m_mask, so iterators stay valid across the seam
+template <typename T, bool Const>
+struct ring_iterator {
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_cv_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T*, T*>;
+    using reference = std::conditional_t<Const, const T&, T&>;
+
+    ring_iterator() = default;
+    ring_iterator(T* data, std::size_t mask, std::size_t pos) : m_data(data), m_mask(mask), m_pos(pos) {
+    }
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    ring_iterator(const ring_iterator<T, false>& rhs) : m_data(rhs.m_data), m_mask(rhs.m_mask), m_pos(rhs.m_pos) {
+    }
+
+    reference operator*() const {
+        return m_data[m_pos & m_mask];
+    }
+    pointer operator->() const {
+        return &**this;
+    }
+    reference operator[](difference_type n) const {
+        return m_data[(m_pos + n) & m_mask];
+    }
+
+    ring_iterator& operator++() {
+        ++m_pos;
+        return *this;
+    }
+    ring_iterator operator++(int) {
+        auto tmp = *this;
+        ++m_pos;
+        return tmp;
+    }
+    ring_iterator& operator--() {
+        --m_pos;
+        return *this;
+    }
+    ring_iterator operator--(int) {
+        auto tmp = *this;
+        --m_pos;
+        return tmp;
+    }
+    ring_iterator& operator+=(difference_type n) {
+        m_pos += n;
+        return *this;
+    }
+    ring_iterator& operator-=(difference_type n) {
+        m_pos -= n;
+        return *this;
+    }
+    friend ring_iterator operator+(ring_iterator it, difference_type n) {
+        return it += n;
+    }
+    friend ring_iterator operator+(difference_type n, ring_iterator it) {
+        return it += n;
+    }
+    friend ring_iterator operator-(ring_iterator it, difference_type n) {
+        return it -= n;
+    }
+    friend difference_type operator-(const ring_iterator& lhs, const ring_iterator& rhs) {
+        return static_cast<difference_type>(lhs.m_pos - rhs.m_pos);
+    }
+
+    friend bool operator==(const ring_iterator& lhs, const ring_iterator& rhs) {
+        return lhs.m_pos == rhs.m_pos;
+    }
+    friend bool operator!=(const ring_iterator& lhs, const ring_iterator& rhs) {
+        return lhs.m_pos != rhs.m_pos;
+    }
+    friend bool operator<(const ring_iterator& lhs, const ring_iterator& rhs) {
+        return lhs - rhs < 0;
+    }
+    friend bool operator>(const ring_iterator& lhs, const ring_iterator& rhs) {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const ring_iterator& lhs, const ring_iterator& rhs) {
+        return !(rhs < lhs);
+    }
+    friend bool operator>=(const ring_iterator& lhs, const ring_iterator& rhs) {
+        return !(lhs < rhs);
+    }
+
+    T* m_data = nullptr;
+    std::size_t m_mask = 0;
+    std::size_t m_pos = 0;
+};
+} // namespace detail
+
+// ring_buffer: double ended queue over one power of two sized allocation, so both ends push and pop in O(1). The
+// elements are at most two contiguous segments, see first_segment() and second_segment(). A ring_buffer<T, false>
+// never reallocates and pushing to a full one is a precondition violation
+template <typename T, bool Growable = true>
+class ring_buffer {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = detail::ring_iterator<T, false>;
+    using const_iterator = detail::ring_iterator<T, true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    ring_buffer() = default;
+    explicit ring_buffer(size_type capacity) {
+        allocate(detail::ceil_pow2(capacity));
+    }
+    ring_buffer(std::initializer_list<T> values) : ring_buffer(values.size()) {
+        for (const auto& v : values)
+            push_back(v);
+    }
+    ring_buffer(const ring_buffer& rhs) : ring_buffer(rhs.capacity()) {
+        for (const auto& v : rhs)
+            push_back(v);
+    }
+    ring_buffer(ring_buffer&& rhs) noexcept
+        : m_data(std::exchange(rhs.m_data, nullptr)), m_capacity(std::exchange(rhs.m_capacity, 0)),
+          m_head(std::exchange(rhs.m_head, 0)), m_size(std::exchange(rhs.m_size, 0)) {
+    }
+    ring_buffer& operator=(ring_buffer rhs) noexcept {
+        swap(rhs);
+        return *this;
+    }
+    ~ring_buffer() {
+        clear();
+        std::allocator<T>().deallocate(m_data, m_capacity);
+    }
+
+    void swap(ring_buffer& rhs) noexcept {
+        using std::swap;
+        swap(m_data, rhs.m_data);
+        swap(m_capacity, rhs.m_capacity);
+        swap(m_head, rhs.m_head);
+        swap(m_size, rhs.m_size);
+    }
+    friend void swap(ring_buffer& lhs, ring_buffer& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    iterator begin() noexcept {
+        return {m_data, mask(), m_head};
+    }
+    iterator end() noexcept {
+        return {m_data, mask(), m_head + m_size};
+    }
+    const_iterator begin() const noexcept {
+        return {m_data, mask(), m_head};
+    }
+    const_iterator end() const noexcept {
+        return {m_data, mask(), m_head + m_size};
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    size_type size() const noexcept {
+        return m_size;
+    }
+    size_type capacity() const noexcept {
+        return m_capacity;
+    }
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+    bool full() const noexcept {
+        return m_size == m_capacity;
+    }
+
+    reference operator[](size_type i) {
+        assert(i < m_size);
+        return m_data[(m_head + i) & mask()];
+    }
+    const_reference operator[](size_type i) const {
+        assert(i < m_size);
+        return m_data[(m_head + i) & mask()];
+    }
+    reference front() {
+        return (*this)[0];
+    }
+    const_reference front() const {
+        return (*this)[0];
+    }
+    reference back() {
+        return (*this)[m_size - 1];
+    }
+    const_reference back() const {
+        return (*this)[m_size - 1];
+    }
+
+    // the elements in order are first_segment() followed by second_segment()
+    span<T> first_segment() noexcept {
+        return {m_data + m_head, std::min(m_size, m_capacity - m_head)};
+    }
+    span<const T> first_segment() const noexcept {
+        return {m_data + m_head, std::min(m_size, m_capacity - m_head)};
+    }
+    span<T> second_segment() noexcept {
+        return {m_data, m_size - first_segment().size()};
+    }
+    span<const T> second_segment() const noexcept {
+        return {m_data, m_size - first_segment().size()};
+    }
+
+    // a fixed ring_buffer gets its capacity in the constructor and has no reserve, so the utilities do not try to grow
+    // it
+    template <bool G = Growable, typename = std::enable_if_t<G>>
+    void reserve(size_type capacity) {
+        if (capacity > m_capacity)
+            reallocate(detail::ceil_pow2(capacity));
+    }
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        if constexpr (Growable) {
+            if (full())
+                return grow_emplace(false, std::forward<Args>(args)...);
+        }
+        assert(!full());
+        auto* p = m_data + ((m_head + m_size) & mask());
+        ::new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+        ++m_size;
+        return *p;
+    }
+    template <typename... Args>
+    reference emplace_front(Args&&... args) {
+        if constexpr (Growable) {
+            if (full())
+                return grow_emplace(true, std::forward<Args>(args)...);
+        }
+        assert(!full());
+        const auto head = (m_head - 1) & mask();
+        ::new (static_cast<void*>(m_data + head)) T(std::forward<Args>(args)...);
+        m_head = head;
+        ++m_size;
+        return m_data[head];
+    }
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+    void push_front(const T& value) {
+        emplace_front(value);
+    }
+    void push_front(T&& value) {
+        emplace_front(std::move(value));
+    }
+
+    void pop_front() {
+        assert(!empty());
+        std::destroy_at(m_data + m_head);
+        m_head = (m_head + 1) & mask();
+        --m_size;
+    }
+    // drops the first n elements, e.g. after copying them out of the segments in bulk
+    void pop_front(size_type n) {
+        assert(n <= m_size);
+        for (size_type i = 0; i < n; ++i)
+            std::destroy_at(m_data + ((m_head + i) & mask()));
+        m_head = (m_head + n) & mask();
+        m_size -= n;
+    }
+    void pop_back() {
+        assert(!empty());
+        std::destroy_at(m_data + ((m_head + m_size - 1) & mask()));
+        --m_size;
+    }
+    void clear() noexcept {
+        pop_front(m_size);
+        m_head = 0;
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        const auto out = begin() + (first - cbegin());
+        const auto count = static_cast<size_type>(last - first);
+        std::move(out + count, end(), out);
+        for (size_type i = 0; i < count; ++i)
+            pop_back();
+        return out;
+    }
+    iterator erase(const_iterator pos) {
+        return erase(pos, std::next(pos));
+    }
+
+private:
+    size_type mask() const noexcept {
+        return m_capacity - 1;
+    }
+
+    void allocate(size_type capacity) {
+        m_data = std::allocator<T>().allocate(capacity);
+        m_capacity = capacity;
+    }
+
+    void reallocate(size_type capacity) {
+        auto next = ring_buffer(capacity);
+        for (auto& v : *this)
+            next.emplace_back(std::move_if_noexcept(v));
+        swap(next);
+    }
+
+    // args may refer to one of the elements, so the new element is built before the old ones move out of the way
+    template <typename... Args>
+    reference grow_emplace(bool front, Args&&... args) {
+        auto next = ring_buffer(std::max<size_type>(8, m_capacity * 2));
+        next.m_head = front ? 0 : m_size;
+        ::new (static_cast<void*>(next.m_data + next.m_head)) T(std::forward<Args>(args)...);
+        next.m_size = 1;
+        if (front) {
+            for (auto& v : *this)
+                next.emplace_back(std::move_if_noexcept(v));
+        } else {
+            for (auto it = rbegin(); it != rend(); ++it)
+                next.emplace_front(std::move_if_noexcept(*it));
+        }
+        swap(next);
+        return front ? this->front() : back();
+    }
+
+    T* m_data = nullptr;
+    size_type m_capacity = 0;
+    size_type m_head = 0;
+    size_type m_size = 0;
+};
+
+// spsc_ring_buffer: bounded lock-free queue between exactly one producer thread and one consumer thread. Each side
+// owns one index and keeps a cached copy of the other's, so the shared indices are only read when the cache says the
+// queue looks full or empty
+template <typename T>
+class spsc_ring_buffer {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    explicit spsc_ring_buffer(size_type capacity)
+        : m_capacity(detail::ceil_pow2(capacity)), m_data(std::allocator<T>().allocate(m_capacity)) {
+    }
+    spsc_ring_buffer(const spsc_ring_buffer&) = delete;
+    spsc_ring_buffer& operator=(const spsc_ring_buffer&) = delete;
+    ~spsc_ring_buffer() {
+        const auto tail = m_producer.m_index.load(std::memory_order_relaxed);
+        for (auto i = m_consumer.m_index.load(std::memory_order_relaxed); i != tail; ++i)
+            std::destroy_at(slot(i));
+        std::allocator<T>().deallocate(m_data, m_capacity);
+    }
+
+    size_type capacity() const noexcept {
+        return m_capacity;
+    }
+    // exact only when neither side is running
+    size_type size_approx() const noexcept {
+        return m_producer.m_index.load(std::memory_order_acquire) - m_consumer.m_index.load(std::memory_order_acquire);
+    }
+
+    // producer side
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        const auto tail = m_producer.m_index.load(std::memory_order_relaxed);
+        if (free_slots(tail, 1) == 0)
+            return false;
+        ::new (static_cast<void*>(slot(tail))) T(std::forward<Args>(args)...);
+        m_producer.m_index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    bool try_push(const T& value) {
+        return try_emplace(value);
+    }
+    bool try_push(T&& value) {
+        return try_emplace(std::move(value));
+    }
+    // pushes as many of [first, first + n) as fit and returns how many that was
+    template <typename InputIt>
+    size_type try_push_n(InputIt first, size_type n) {
+        const auto tail = m_producer.m_index.load(std::memory_order_relaxed);
+        n = std::min(n, free_slots(tail, n));
+        for (size_type i = 0; i < n; ++i, ++first)
+            ::new (static_cast<void*>(slot(tail + i))) T(*first);
+        m_producer.m_index.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // consumer side
+    bool try_pop(T& out) {
+        return try_pop_n(&out, 1) == 1;
+    }
+    // moves up to n elements to out and returns how many that was
+    template <typename OutputIt>
+    size_type try_pop_n(OutputIt out, size_type n) {
+        const auto head = m_consumer.m_index.load(std::memory_order_relaxed);
+        n = std::min(n, filled_slots(head, n));
+        for (size_type i = 0; i < n; ++i, ++out) {
+            *out = std::move(*slot(head + i));
+            std::destroy_at(slot(head + i));
+        }
+        m_consumer.m_index.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    T* slot(size_type index) const noexcept {
+        return m_data + (index & (m_capacity - 1));
+    }
+
+    // at least wanted, or as many as there are once the other side's index has been re-read
+    size_type free_slots(size_type tail, size_type wanted) {
+        if (m_capacity - (tail - m_producer.m_cached) < wanted)
+            m_producer.m_cached = m_consumer.m_index.load(std::memory_order_acquire);
+        return m_capacity - (tail - m_producer.m_cached);
+    }
+
+    size_type filled_slots(size_type head, size_type wanted) {
+        if (m_consumer.m_cached - head < wanted)
+            m_consumer.m_cached = m_producer.m_index.load(std::memory_order_acquire);
+        return m_consumer.m_cached - head;
+    }
+
+    // m_index is written by the owning side, m_cached is that side's last view of the other side's index
+    struct alignas(detail::cache_line_size) side {
+        std::atomic<size_type> m_index{0};
+        size_type m_cached = 0;
+    };
+
+    const size_type m_capacity;
+    T* const m_data;
+    side m_producer;
+    side m_consumer;
+};
+} // namespace mleivo::cu
@@ -0,0 +1,425 @@
+/*
+ * Copyright 2023 Marcus Leivo
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define MLEIVO_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define MLEIVO_SIMD_X86 0
+#endif
+
+namespace mleivo::simd {
+// instruction sets the kernels are compiled for, picked at runtime by best_isa()
+enum class isa {
+    scalar,
+    sse2,
+    avx2,
+    avx512,
+};
+
+inline isa detect_isa() {
+#if MLEIVO_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return isa::avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return isa::avx2;
+    return isa::sse2;
+#else
+    return isa::scalar;
+#endif
+}
+
+inline isa best_isa() {
+    static const auto value = detect_isa();
+    return value;
+}
+
+// integers, enums and pointers are compared as their bit patterns, floating point values with ==
+template <typename T>
+inline constexpr bool is_simd_comparable_v =
+    (std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T> || std::is_same_v<T, float>
+     || std::is_same_v<T, double>)
+    && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+namespace detail {
+template <std::size_t Size>
+using uint_t = std::conditional_t<
+    Size == 1, std::uint8_t,
+    std::conditional_t<Size == 2, std::uint16_t, std::conditional_t<Size == 4, std::uint32_t, std::uint64_t>>>;
+
+template <typename T>
+using lane_t = std::conditional_t<std::is_floating_point_v<T>, T, uint_t<sizeof(T)>>;
+
+template <typename To, typename From>
+To bit_cast(const From& from) {
+    static_assert(sizeof(To) == sizeof(From));
+    To to;
+    std::memcpy(&to, &from, sizeof(To));
+    return to;
+}
+
+template <typename T>
+int ctz(T mask) {
+    if constexpr (sizeof(T) <= 4)
+        return __builtin_ctz(static_cast<unsigned>(mask));
+    else
+        return __builtin_ctzll(static_cast<unsigned long long>(mask));
+}
+
+#if MLEIVO_SIMD_X86
+// each kernel returns the index of the first lane equal to value, or the index of the first element left for the
+// scalar tail. the data is only read through vector loads, so lanes may alias enums and pointers.
+template <typename T>
+__attribute__((target("sse2"))) std::size_t find_sse2(const T* data, std::size_t n, T value) {
+    constexpr auto lanes = 16 / sizeof(T);
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        int mask;
+        if constexpr (std::is_same_v<T, float>) {
+            mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + i), _mm_set1_ps(value)));
+        } else if constexpr (std::is_same_v<T, double>) {
+            mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(data + i), _mm_set1_pd(value)));
+        } else {
+            const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i eq;
+            if constexpr (sizeof(T) == 1) {
+                eq = _mm_cmpeq_epi8(block, _mm_set1_epi8(static_cast<char>(value)));
+            } else if constexpr (sizeof(T) == 2) {
+                eq = _mm_cmpeq_epi16(block, _mm_set1_epi16(static_cast<short>(value)));
+            } else if constexpr (sizeof(T) == 4) {
+                eq = _mm_cmpeq_epi32(block, _mm_set1_epi32(static_cast<int>(value)));
+            } else {
+                // no 64-bit compare before SSE4.1: both 32-bit halves have to match
+                eq = _mm_cmpeq_epi32(block, _mm_set1_epi64x(static_cast<long long>(value)));
+                eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+            }
+            mask = _mm_movemask_epi8(eq);
+            if (mask != 0)
+                return i + ctz(mask) / sizeof(T);
+            continue;
+        }
+        if (mask != 0)
+            return i + ctz(mask);
+    }
+    return i;
+}
+
+template <typename T>
+__attribute__((target("avx2"))) std::size_t find_avx2(const T* data, std::size_t n, T value) {
+    constexpr auto lanes = 32 / sizeof(T);
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        int mask;
+        if constexpr (std::is_same_v<T, float>) {
+            mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), _mm256_set1_ps(value), _CMP_EQ_OQ));
+        } else if constexpr (std::is_same_v<T, double>) {
+            mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i), _mm256_set1_pd(value), _CMP_EQ_OQ));
+        } else {
+            const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i eq;
+            if constexpr (sizeof(T) == 1)
+                eq = _mm256_cmpeq_epi8(block, _mm256_set1_epi8(static_cast<char>(value)));
+            else if constexpr (sizeof(T) == 2)
+                eq = _mm256_cmpeq_epi16(block, _mm256_set1_epi16(static_cast<short>(value)));
+            else if constexpr (sizeof(T) == 4)
+                eq = _mm256_cmpeq_epi32(block, _mm256_set1_epi32(static_cast<int>(value)));
+            else
+                eq = _mm256_cmpeq_epi64(block, _mm256_set1_epi64x(static_cast<long long>(value)));
+            mask = _mm256_movemask_epi8(eq);
+            if (mask != 0)
+                return i + ctz(mask) / sizeof(T);
+            continue;
+        }
+        if (mask != 0)
+            return i + ctz(mask);
+    }
+    return i + find_sse2(data + i, n - i, value);
+}
+
+template <typename T>
+__attribute__((target("avx512f,avx512bw"))) std::size_t find_avx512(const T* data, std::size_t n, T value) {
+    constexpr auto lanes = 64 / sizeof(T);
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        std::uint64_t mask;
+        if constexpr (std::is_same_v<T, float>) {
+            mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(data + i), _mm512_set1_ps(value), _CMP_EQ_OQ);
+        } else if constexpr (std::is_same_v<T, double>) {
+            mask = _mm512_cmp_pd_mask(_mm512_loadu_pd(data + i), _mm512_set1_pd(value), _CMP_EQ_OQ);
+        } else {
+            const auto block = _mm512_loadu_si512(data + i);
+            if constexpr (sizeof(T) == 1)
+                mask = _mm512_cmpeq_epi8_mask(block, _mm512_set1_epi8(static_cast<char>(value)));
+            else if constexpr (sizeof(T) == 2)
+                mask = _mm512_cmpeq_epi16_mask(block, _mm512_set1_epi16(static_cast<short>(value)));
+            else if constexpr (sizeof(T) == 4)
+                mask = _mm512_cmpeq_epi32_mask(block, _mm512_set1_epi32(static_cast<int>(value)));
+            else
+                mask = _mm512_cmpeq_epi64_mask(block, _mm512_set1_epi64(static_cast<long long>(value)));
+        }
+        if (mask != 0)
+            return i + ctz(mask);
+    }
+    return i + find_avx2(data + i, n - i, value);
+}
+#endif
+
+template <typename T>
+std::size_t find_index(const T* data, std::size_t n, T value, isa level) {
+#if MLEIVO_SIMD_X86
+    switch (level) {
+    case isa::avx512:
+        return find_avx512(data, n, value);
+    case isa::avx2:
+        return find_avx2(data, n, value);
+    case isa::sse2:
+        return find_sse2(data, n, value);
+    case isa::scalar:
+        break;
+    }
+#endif
+    return 0;
+}
+} // namespace detail
+
+// find: std::find over contiguous memory. integers, enums, pointers and floating point values are compared 16 to 64
+// elements at a time with the widest instruction set the cpu supports.
+template <typename T>
+const T* find(const T* first, const T* last, const T& value, isa level = best_isa()) {
+    if constexpr (is_simd_comparable_v<T>) {
+        using lane = detail::lane_t<T>;
+        const auto n = static_cast<std::size_t>(last - first);
+        if constexpr (sizeof(T) == 1) {
+            if (level != isa::scalar) {
+                const auto* pos = n == 0 ? nullptr : std::memchr(first, detail::bit_cast<unsigned char>(value), n);
+                return pos ? static_cast<const T*>(pos) : last;
+            }
+        }
+        const auto* lanes = reinterpret_cast<const lane*>(first);
+        const auto i = detail::find_index(lanes, n, detail::bit_cast<lane>(value), level);
+        return std::find(first + i, last, value);
+    } else {
+        return std::find(first, last, value);
+    }
+}
+
+template <typename T, typename = std::enable_if_t<!std::is_const_v<T>>>
+T* find(T* first, T* last, const T& value, isa level = best_isa()) {
+    return const_cast<T*>(find(static_cast<const T*>(first), static_cast<const T*>(last), value, level));
+}
+
+namespace detail {
+template <typename T, typename U>
+constexpr bool cmp_less(T t, U u) {
+    if constexpr (std::is_signed_v<T> == std::is_signed_v<U>)
+        return t < u;
+    else if constexpr (std::is_signed_v<T>)
+        return t < 0 || static_cast<std::make_unsigned_t<T>>(t) < u;
+    else
+        return u >= 0 && t < static_cast<std::make_unsigned_t<U>>(u);
+}
+} // namespace detail
+
+// saturate_cast: static_cast that clamps out of range values to the limits of To, and maps NaN to 0 for integers
+template <typename To, typename From>
+constexpr To saturate_cast(From value) {
+    using limits = std::numeric_limits<To>;
+    if constexpr (std::is_integral_v<To> && std::is_floating_point_v<From>) {
+        if (value != value)
+            return To{};
+        if (value <= static_cast<From>(limits::lowest()))
+            return limits::lowest();
+        if (value >= static_cast<From>(limits::max()))
+            return limits::max();
+        return static_cast<To>(value);
+    } else if constexpr (std::is_integral_v<To> && std::is_integral_v<From>) {
+        if (detail::cmp_less(value, limits::lowest()))
+            return limits::lowest();
+        if (detail::cmp_less(limits::max(), value))
+            return limits::max();
+        return static_cast<To>(value);
+    } else if constexpr (std::is_floating_point_v<To> && std::is_floating_point_v<From> && sizeof(To) < sizeof(From)) {
+        if (value < static_cast<From>(limits::lowest()))
+            return limits::lowest();
+        if (value > static_cast<From>(limits::max()))
+            return limits::max();
+        return static_cast<To>(value);
+    } else {
+        return static_cast<To>(value);
+    }
+}
+
+namespace detail {
+template <bool Saturate, typename To, typename From>
+constexpr To convert_one(From value) {
+    if constexpr (Saturate)
+        return saturate_cast<To>(value);
+    else
+        return static_cast<To>(value);
+}
+
+template <bool Saturate, typename From, typename To>
+void convert_scalar(const From* in, To* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = convert_one<Saturate, To>(in[i]);
+}
+
+#if MLEIVO_SIMD_X86
+// the kernels convert whole vectors of the common storage/compute pairs and leave the tail, and every other pair, to
+// a plain loop that the compiler may vectorize for the same target
+template <bool Saturate, typename From, typename To>
+__attribute__((target("sse2"))) void convert_sse2(const From* in, To* out, std::size_t n) {
+    convert_scalar<Saturate>(in, out, n);
+}
+
+template <bool Saturate, typename From, typename To>
+__attribute__((target("avx2"))) void convert_avx2(const From* in, To* out, std::size_t n) {
+    std::size_t i = 0;
+    if constexpr (std::is_same_v<From, std::int32_t> && std::is_same_v<To, float>) {
+        for (; i + 8 <= n; i += 8) {
+            const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            _mm256_storeu_ps(out + i, _mm256_cvtepi32_ps(v));
+        }
+    } else if constexpr (std::is_same_v<From, float> && std::is_same_v<To, std::int32_t>) {
+        for (; i + 8 <= n; i += 8) {
+            const auto v = _mm256_loadu_ps(in + i);
+            auto r = _mm256_cvttps_epi32(v);
+            if constexpr (Saturate) {
+                // the conversion yields INT_MIN for anything out of range, which is only right below the range
+                const auto too_big = _mm256_castps_si256(_mm256_cmp_ps(v, _mm256_set1_ps(2147483648.0f), _CMP_GE_OQ));
+                r = _mm256_blendv_epi8(r, _mm256_set1_epi32(std::numeric_limits<std::int32_t>::max()), too_big);
+                r = _mm256_and_si256(r, _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_ORD_Q)));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+        }
+    } else if constexpr (std::is_same_v<From, double> && std::is_same_v<To, float>) {
+        for (; i + 4 <= n; i += 4) {
+            auto v = _mm256_loadu_pd(in + i);
+            if constexpr (Saturate) {
+                // min/max return their second operand for NaN, so NaN passes through
+                v = _mm256_min_pd(_mm256_set1_pd(std::numeric_limits<float>::max()), v);
+                v = _mm256_max_pd(_mm256_set1_pd(std::numeric_limits<float>::lowest()), v);
+            }
+            _mm_storeu_ps(out + i, _mm256_cvtpd_ps(v));
+        }
+    } else if constexpr (std::is_same_v<From, std::int64_t> && std::is_same_v<To, std::int32_t>) {
+        const auto low_halves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+        for (; i + 4 <= n; i += 4) {
+            auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            if constexpr (Saturate) {
+                const auto max = _mm256_set1_epi64x(std::numeric_limits<std::int32_t>::max());
+                const auto min = _mm256_set1_epi64x(std::numeric_limits<std::int32_t>::min());
+                v = _mm256_blendv_epi8(v, max, _mm256_cmpgt_epi64(v, max));
+                v = _mm256_blendv_epi8(v, min, _mm256_cmpgt_epi64(min, v));
+            }
+            const auto packed = _mm256_permutevar8x32_epi32(v, low_halves);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(packed));
+        }
+    } else if constexpr (std::is_same_v<From, std::uint8_t>
+                         && (std::is_same_v<To, std::int32_t> || std::is_same_v<To, float>)) {
+        for (; i + 8 <= n; i += 8) {
+            const auto bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i));
+            const auto v = _mm256_cvtepu8_epi32(bytes);
+            if constexpr (std::is_same_v<To, float>)
+                _mm256_storeu_ps(out + i, _mm256_cvtepi32_ps(v));
+            else
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+        }
+    }
+    convert_scalar<Saturate>(in + i, out + i, n - i);
+}
+
+template <bool Saturate, typename From, typename To>
+__attribute__((target("avx512f,avx512bw"))) void convert_avx512(const From* in, To* out, std::size_t n) {
+    // the unmasked conversions are written on top of _mm512_undefined_*(), which gcc 12 reports as
+    // -Wmaybe-uninitialized; the zero-masked forms with every lane enabled compile to the same instructions
+    constexpr __mmask16 all16 = 0xffff;
+    constexpr __mmask8 all8 = 0xff;
+    std::size_t i = 0;
+    if constexpr (std::is_same_v<From, std::int32_t> && std::is_same_v<To, float>) {
+        for (; i + 16 <= n; i += 16)
+            _mm512_storeu_ps(out + i, _mm512_maskz_cvtepi32_ps(all16, _mm512_loadu_si512(in + i)));
+    } else if constexpr (std::is_same_v<From, float> && std::is_same_v<To, std::int32_t>) {
+        for (; i + 16 <= n; i += 16) {
+            const auto v = _mm512_loadu_ps(in + i);
+            auto r = _mm512_maskz_cvttps_epi32(all16, v);
+            if constexpr (Saturate) {
+                const auto too_big = _mm512_cmp_ps_mask(v, _mm512_set1_ps(2147483648.0f), _CMP_GE_OQ);
+                r = _mm512_mask_mov_epi32(r, too_big, _mm512_set1_epi32(std::numeric_limits<std::int32_t>::max()));
+                r = _mm512_maskz_mov_epi32(_mm512_cmp_ps_mask(v, v, _CMP_ORD_Q), r);
+            }
+            _mm512_storeu_si512(out + i, r);
+        }
+    } else if constexpr (std::is_same_v<From, double> && std::is_same_v<To, float>) {
+        for (; i + 8 <= n; i += 8) {
+            auto v = _mm512_loadu_pd(in + i);
+            if constexpr (Saturate) {
+                v = _mm512_maskz_min_pd(all8, _mm512_set1_pd(std::numeric_limits<float>::max()), v);
+                v = _mm512_maskz_max_pd(all8, _mm512_set1_pd(std::numeric_limits<float>::lowest()), v);
+            }
+            _mm256_storeu_ps(out + i, _mm512_maskz_cvtpd_ps(all8, v));
+        }
+    } else if constexpr (std::is_same_v<From, std::int64_t> && std::is_same_v<To, std::int32_t>) {
+        for (; i + 8 <= n; i += 8) {
+            const auto v = _mm512_loadu_si512(in + i);
+            const auto r = Saturate ? _mm512_maskz_cvtsepi64_epi32(all8, v) : _mm512_maskz_cvtepi64_epi32(all8, v);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+        }
+    } else if constexpr (std::is_same_v<From, std::uint8_t>
+                         && (std::is_same_v<To, std::int32_t> || std::is_same_v<To, float>)) {
+        for (; i + 16 <= n; i += 16) {
+            const auto v = _mm512_maskz_cvtepu8_epi32(all16, _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+            if constexpr (std::is_same_v<To, float>)
+                _mm512_storeu_ps(out + i, _mm512_maskz_cvtepi32_ps(all16, v));
+            else
+                _mm512_storeu_si512(out + i, v);
+        }
+    }
+    convert_avx2<Saturate>(in + i, out + i, n - i);
+}
+#endif
+} // namespace detail
+
+// convert: out[i] = static_cast<To>(in[i]) (saturate_cast<To> when Saturate) for arithmetic types, using the widest
+// conversion instructions the cpu supports
+template <bool Saturate = false, typename From, typename To>
+void convert(const From* in, To* out, std::size_t n, isa level = best_isa()) {
+    static_assert(std::is_arithmetic_v<From> && std::is_arithmetic_v<To>);
+#if MLEIVO_SIMD_X86
+    switch (level) {
+    case isa::avx512:
+        return detail::convert_avx512<Saturate>(in, out, n);
+    case isa::avx2:
+        return detail::convert_avx2<Saturate>(in, out, n);
+    case isa::sse2:
+        return detail::convert_sse2<Saturate>(in, out, n);
+    case isa::scalar:
+        break;
+    }
+#endif
+    detail::convert_scalar<Saturate>(in, out, n);
+}
+} // namespace mleivo::simd
@@ -0,0 +1,347 @@
+/*
+ * Copyright 2023 Marcus Leivo
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace mleivo::cu {
+// small_vector: a vector that keeps up to N elements inline and moves to the heap beyond that, so short results cost
+// no allocation. A small_vector<T, N, false>, spelled static_vector<T, N>, never allocates and growing one past N is a
+// precondition violation
+template <typename T, std::size_t N, bool Growable = true>
+class small_vector {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    small_vector() noexcept {
+    }
+    explicit small_vector(size_type count) {
+        resize(count);
+    }
+    small_vector(size_type count, const T& value) {
+        resize(count, value);
+    }
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    small_vector(InputIt first, InputIt last) {
+        insert(end(), first, last);
+    }
+    small_vector(std::initializer_list<T> values) : small_vector(values.begin(), values.end()) {
+    }
+    small_vector(const small_vector& rhs) : small_vector(rhs.begin(), rhs.end()) {
+    }
+    small_vector(small_vector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        take(std::move(rhs));
+    }
+    small_vector& operator=(const small_vector& rhs) {
+        if (this != &rhs) {
+            clear();
+            insert(end(), rhs.begin(), rhs.end());
+        }
+        return *this;
+    }
+    small_vector& operator=(small_vector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            clear();
+            release();
+            take(std::move(rhs));
+        }
+        return *this;
+    }
+    small_vector& operator=(std::initializer_list<T> values) {
+        clear();
+        insert(end(), values.begin(), values.end());
+        return *this;
+    }
+    ~small_vector() {
+        clear();
+        release();
+    }
+
+    void swap(small_vector& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        auto tmp = std::move(rhs);
+        rhs = std::move(*this);
+        *this = std::move(tmp);
+    }
+    friend void swap(small_vector& lhs, small_vector& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        lhs.swap(rhs);
+    }
+
+    iterator begin() noexcept {
+        return data();
+    }
+    iterator end() noexcept {
+        return data() + m_size;
+    }
+    const_iterator begin() const noexcept {
+        return data();
+    }
+    const_iterator end() const noexcept {
+        return data() + m_size;
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    T* data() noexcept {
+        return is_inline() ? inline_data() : m_heap;
+    }
+    const T* data() const noexcept {
+        return is_inline() ? inline_data() : m_heap;
+    }
+    size_type size() const noexcept {
+        return m_size;
+    }
+    size_type capacity() const noexcept {
+        return Growable ? m_capacity : N;
+    }
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+    // true while the elements live in the object itself, always for a static_vector
+    bool is_inline() const noexcept {
+        return !Growable || m_capacity == N;
+    }
+
+    reference operator[](size_type i) {
+        assert(i < m_size);
+        return data()[i];
+    }
+    const_reference operator[](size_type i) const {
+        assert(i < m_size);
+        return data()[i];
+    }
+    reference front() {
+        return (*this)[0];
+    }
+    const_reference front() const {
+        return (*this)[0];
+    }
+    reference back() {
+        return (*this)[m_size - 1];
+    }
+    const_reference back() const {
+        return (*this)[m_size - 1];
+    }
+
+    // a static_vector has no reserve, so the utilities do not try to grow it
+    template <bool G = Growable, typename = std::enable_if_t<G>>
+    void reserve(size_type capacity) {
+        if (capacity > m_capacity)
+            reallocate(capacity);
+    }
+    void resize(size_type count) {
+        resize_with(count, [](T* p) { ::new (static_cast<void*>(p)) T(); });
+    }
+    void resize(size_type count, const T& value) {
+        resize_with(count, [&value](T* p) { ::new (static_cast<void*>(p)) T(value); });
+    }
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        const auto construct = [&args...](T* p) { ::new (static_cast<void*>(p)) T(std::forward<Args>(args)...); };
+        if (m_size == m_capacity)
+            grow(m_size + 1, construct);
+        else
+            construct(data() + m_size);
+        ++m_size;
+        return back();
+    }
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+    void pop_back() {
+        assert(!empty());
+        std::destroy_at(data() + --m_size);
+    }
+    void clear() noexcept {
+        std::destroy(begin(), end());
+        m_size = 0;
+    }
+
+    // appends at the end and rotates into place. A forward range that does not fit is copied into the new storage in
+    // one go, before the old elements it may point into move over
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        const auto offset = pos - cbegin();
+        const auto old_size = m_size;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<InputIt>::iterator_category>) {
+            const auto count = static_cast<size_type>(std::distance(first, last));
+            if (m_size + count > m_capacity) {
+                grow(m_size + count, [first, last](T* p) { std::uninitialized_copy(first, last, p); });
+                m_size += count;
+                std::rotate(begin() + offset, begin() + old_size, end());
+                return begin() + offset;
+            }
+        }
+        for (; first != last; ++first)
+            emplace_back(*first);
+        std::rotate(begin() + offset, begin() + old_size, end());
+        return begin() + offset;
+    }
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        const auto offset = pos - cbegin();
+        emplace_back(std::forward<Args>(args)...);
+        std::rotate(begin() + offset, end() - 1, end());
+        return begin() + offset;
+    }
+    iterator insert(const_iterator pos, const T& value) {
+        return emplace(pos, value);
+    }
+    iterator insert(const_iterator pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        const auto out = begin() + (first - cbegin());
+        const auto count = static_cast<size_type>(last - first);
+        std::move(out + count, end(), out);
+        for (size_type i = 0; i < count; ++i)
+            pop_back();
+        return out;
+    }
+    iterator erase(const_iterator pos) {
+        return erase(pos, std::next(pos));
+    }
+
+    friend bool operator==(const small_vector& lhs, const small_vector& rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+    friend bool operator!=(const small_vector& lhs, const small_vector& rhs) {
+        return !(lhs == rhs);
+    }
+    friend bool operator<(const small_vector& lhs, const small_vector& rhs) {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    T* inline_data() noexcept {
+        return reinterpret_cast<T*>(m_inline);
+    }
+    const T* inline_data() const noexcept {
+        return reinterpret_cast<const T*>(m_inline);
+    }
+
+    template <typename ConstructT>
+    void resize_with(size_type count, ConstructT construct) {
+        if (count > m_capacity)
+            grow(count);
+        for (; m_size < count; ++m_size)
+            construct(data() + m_size);
+        while (m_size > count)
+            pop_back();
+    }
+
+    // construct builds the new elements past the end, see reallocate
+    template <typename ConstructT = void (*)(T*)>
+    void grow(size_type capacity, ConstructT construct = [](T*) {}) {
+        if constexpr (Growable) {
+            reallocate(std::max(capacity, 2 * m_capacity), construct);
+        } else {
+            assert(capacity <= N && "a static_vector never grows past N");
+            construct(data() + m_size);
+        }
+    }
+
+    // construct builds the new elements past the end of the new storage before the old ones move over, since its
+    // arguments may refer to the old ones
+    template <typename ConstructT = void (*)(T*)>
+    void reallocate(size_type capacity, ConstructT construct = [](T*) {}) {
+        auto* next = std::allocator<T>().allocate(capacity);
+        construct(next + m_size);
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+            std::uninitialized_move(begin(), end(), next);
+        else
+            std::uninitialized_copy(begin(), end(), next);
+        std::destroy(begin(), end());
+        release();
+        m_heap = next;
+        m_capacity = capacity;
+    }
+
+    // frees the heap storage of an empty vector and goes back to the inline one
+    void release() noexcept {
+        if (!is_inline())
+            std::allocator<T>().deallocate(m_heap, m_capacity);
+        m_capacity = N;
+    }
+
+    // steals a heap allocation, inline elements are moved one by one. rhs is left empty
+    void take(small_vector&& rhs) {
+        if (rhs.is_inline()) {
+            if constexpr (std::is_move_constructible_v<T>)
+                std::uninitialized_move(rhs.begin(), rhs.end(), inline_data());
+            else
+                std::uninitialized_copy(rhs.begin(), rhs.end(), inline_data());
+            m_size = rhs.m_size;
+            rhs.clear();
+        } else {
+            m_heap = rhs.m_heap;
+            m_capacity = rhs.m_capacity;
+            m_size = std::exchange(rhs.m_size, 0);
+            rhs.m_capacity = N;
+        }
+    }
+
+    // the heap pointer only matters once the inline storage is left behind, so the two share their bytes
+    union {
+        alignas(T) unsigned char m_inline[sizeof(T) * std::max<std::size_t>(N, 1)];
+        T* m_heap;
+    };
+    size_type m_size = 0;
+    size_type m_capacity = N;
+};
+
+template <typename T, std::size_t N>
+using static_vector = small_vector<T, N, false>;
+} // namespace mleivo::cu
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2023 Marcus Leivo
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace mleivo::cu {
+// span: non-owning view of contiguous elements, a C++17 stand-in for std::span<T>
+template <typename T>
+struct span {
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+    using iterator = T*;
+
+    constexpr span() = default;
+    constexpr span(T* data, size_type size) : m_data(data), m_size(size) {
+    }
+
+    constexpr iterator begin() const {
+        return m_data;
+    }
+    constexpr iterator end() const {
+        return m_data + m_size;
+    }
+
+    constexpr pointer data() const {
+        return m_data;
+    }
+    constexpr size_type size() const {
+        return m_size;
+    }
+    constexpr bool empty() const {
+        return m_size == 0;
+    }
+
+    constexpr reference operator[](size_type i) const {
+        assert(i < m_size);
+        return m_data[i];
+    }
+    constexpr reference front() const {
+        assert(!empty());
+        return m_data[0];
+    }
+    constexpr reference back() const {
+        assert(!empty());
+        return m_data[m_size - 1];
+    }
+
+private:
+    T* m_data = nullptr;
+    size_type m_size = 0;
+};
+} // namespace mleivo::cu
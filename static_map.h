@@ -0,0 +1,314 @@
+/*
+ * Copyright 2023 Marcus Leivo
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace mleivo::cu {
+namespace detail {
+// the splitmix64 finalizer, every input bit reaches every output bit
+constexpr std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+} // namespace detail
+
+// static_hash: the constexpr hash static_map and static_set use by default, for strings, integers and enums
+struct static_hash {
+    constexpr std::uint64_t operator()(std::string_view s) const {
+        auto h = std::uint64_t{0xcbf29ce484222325}; // fnv-1a
+        for (const auto c : s) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 0x100000001b3;
+        }
+        return detail::mix64(h);
+    }
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>>>
+    constexpr std::uint64_t operator()(T value) const {
+        if constexpr (std::is_enum_v<T>)
+            return detail::mix64(static_cast<std::uint64_t>(static_cast<std::underlying_type_t<T>>(value)));
+        else
+            return detail::mix64(static_cast<std::uint64_t>(value));
+    }
+};
+
+namespace detail {
+// perfect hash for N keys over a power of two number of slots, built by hash and displace: the high bits of a key's
+// hash pick its bucket and each bucket stores the seed that sends all of its keys to distinct free slots. The biggest
+// buckets are placed first, buckets of one key take any free slot directly. A lookup is one hash, one seeded remix and
+// two table reads, and the slot names the only key the looked up one can be
+template <std::size_t N>
+class perfect_hash_table {
+public:
+    static constexpr std::size_t size = [] {
+        auto out = std::size_t{1};
+        while (out < N)
+            out <<= 1;
+        return out;
+    }();
+
+    // equal(i, j) tells whether keys i and j are the same key, which makes the table impossible to build
+    template <typename EqualT>
+    constexpr perfect_hash_table(const std::array<std::uint64_t, N>& hashes, EqualT equal) {
+        // the keys ordered by bucket, bucket b owning [start[b], start[b + 1])
+        auto start = std::array<std::size_t, size + 1>{};
+        for (std::size_t i = 0; i < N; ++i)
+            ++start[bucket(hashes[i]) + 1];
+        for (std::size_t b = 0; b < size; ++b)
+            start[b + 1] += start[b];
+        auto members = std::array<std::size_t, N>{};
+        auto next = std::array<std::size_t, size>{};
+        for (std::size_t b = 0; b < size; ++b)
+            next[b] = start[b];
+        for (std::size_t i = 0; i < N; ++i)
+            members[next[bucket(hashes[i])]++] = i;
+
+        auto order = std::array<std::size_t, size>{};
+        for (std::size_t b = 0; b < size; ++b)
+            order[b] = b;
+        const auto bucket_size = [&start](std::size_t b) { return start[b + 1] - start[b]; };
+        for (std::size_t i = 1; i < size; ++i) {
+            for (auto j = i; j > 0 && bucket_size(order[j - 1]) < bucket_size(order[j]); --j) {
+                const auto tmp = order[j];
+                order[j] = order[j - 1];
+                order[j - 1] = tmp;
+            }
+        }
+
+        for (auto& s : m_slots)
+            s = static_cast<std::uint32_t>(N);
+        auto used = std::array<bool, size>{};
+        auto free_slot = std::size_t{0};
+        for (const auto b : order) {
+            const auto first = start[b];
+            const auto last = start[b + 1];
+            if (last - first == 0)
+                break;
+            if (last - first == 1) {
+                while (used[free_slot])
+                    ++free_slot;
+                used[free_slot] = true;
+                m_slots[free_slot] = static_cast<std::uint32_t>(members[first]);
+                m_buckets[b] = -static_cast<std::int32_t>(free_slot) - 1;
+                continue;
+            }
+            for (auto i = first; i < last; ++i) {
+                for (auto j = i + 1; j < last; ++j) {
+                    if (equal(members[i], members[j]))
+                        throw std::invalid_argument("the same key twice in a static_map or static_set");
+                }
+            }
+            for (std::int32_t seed = 0;; ++seed) {
+                if (seed == max_seed)
+                    throw std::logic_error("no perfect hash found, the keys' hashes collide");
+                if (fits(hashes, members, first, last, seed, used)) {
+                    for (auto i = first; i < last; ++i) {
+                        const auto s = slot(hashes[members[i]], seed);
+                        used[s] = true;
+                        m_slots[s] = static_cast<std::uint32_t>(members[i]);
+                    }
+                    m_buckets[b] = seed;
+                    break;
+                }
+            }
+        }
+    }
+
+    // the index of the only key that hashes to h, or N for an empty slot
+    constexpr std::size_t index(std::uint64_t h) const {
+        return m_slots[slot(h, m_buckets[bucket(h)])];
+    }
+
+private:
+    static constexpr std::int32_t max_seed = 1 << 20;
+
+    static constexpr std::size_t bucket(std::uint64_t h) {
+        return static_cast<std::size_t>(h >> 32) & (size - 1);
+    }
+    // a negative displacement is the slot itself, of a bucket with a single key
+    static constexpr std::size_t slot(std::uint64_t h, std::int32_t displacement) {
+        if (displacement < 0)
+            return static_cast<std::size_t>(-(displacement + 1));
+        const auto seed = static_cast<std::uint64_t>(displacement) * 0x9e3779b97f4a7c15;
+        return static_cast<std::size_t>(mix64(h ^ seed)) & (size - 1);
+    }
+
+    static constexpr bool fits(const std::array<std::uint64_t, N>& hashes, const std::array<std::size_t, N>& members,
+                               std::size_t first, std::size_t last, std::int32_t seed,
+                               const std::array<bool, size>& used) {
+        for (auto i = first; i < last; ++i) {
+            const auto s = slot(hashes[members[i]], seed);
+            if (used[s])
+                return false;
+            for (auto j = first; j < i; ++j) {
+                if (slot(hashes[members[j]], seed) == s)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    std::array<std::int32_t, size> m_buckets{};
+    std::array<std::uint32_t, size> m_slots{};
+};
+
+template <typename Hash, typename T, std::size_t N, typename KeyOf>
+constexpr std::array<std::uint64_t, N> hashes_of(const std::array<T, N>& items, KeyOf key_of) {
+    auto out = std::array<std::uint64_t, N>{};
+    for (std::size_t i = 0; i < N; ++i)
+        out[i] = Hash{}(key_of(items[i]));
+    return out;
+}
+
+template <typename T, std::size_t N, std::size_t... I>
+constexpr std::array<T, N> to_array(const T (&items)[N], std::index_sequence<I...>) {
+    return {{items[I]...}};
+}
+} // namespace detail
+
+// static_map: a constant table of N key value pairs with a perfect hash computed when it is constructed, at compile
+// time for a constexpr one, so it needs no heap and no initialization at startup. Build one with make_static_map
+template <typename Key, typename Value, std::size_t N, typename Hash = static_hash, typename KeyEqual = std::equal_to<>>
+class static_map {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using const_iterator = const value_type*;
+    using iterator = const_iterator;
+
+    constexpr explicit static_map(const std::array<value_type, N>& items)
+        : m_items(items), m_table(detail::hashes_of<Hash>(items, [](const value_type& kv) { return kv.first; }),
+                                  [&items](std::size_t i, std::size_t j) {
+                                      return KeyEqual{}(items[i].first, items[j].first);
+                                  }) {
+    }
+
+    // the pairs in the order they were given
+    constexpr const_iterator begin() const noexcept {
+        return m_items.data();
+    }
+    constexpr const_iterator end() const noexcept {
+        return m_items.data() + N;
+    }
+    constexpr size_type size() const noexcept {
+        return N;
+    }
+    constexpr bool empty() const noexcept {
+        return N == 0;
+    }
+
+    template <typename K>
+    constexpr const_iterator find(const K& key) const {
+        const auto i = m_table.index(Hash{}(key));
+        return i != N && KeyEqual{}(m_items[i].first, key) ? begin() + i : end();
+    }
+    template <typename K>
+    constexpr bool contains(const K& key) const {
+        return find(key) != end();
+    }
+    template <typename K>
+    constexpr size_type count(const K& key) const {
+        return contains(key) ? 1 : 0;
+    }
+    template <typename K>
+    constexpr const Value& at(const K& key) const {
+        const auto it = find(key);
+        if (it == end())
+            throw std::out_of_range("static_map::at");
+        return it->second;
+    }
+
+private:
+    std::array<value_type, N> m_items;
+    detail::perfect_hash_table<N> m_table;
+};
+
+// static_set: the keys of a static_map without the values. Build one with make_static_set
+template <typename Key, std::size_t N, typename Hash = static_hash, typename KeyEqual = std::equal_to<>>
+class static_set {
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using const_iterator = const Key*;
+    using iterator = const_iterator;
+
+    constexpr explicit static_set(const std::array<Key, N>& keys)
+        : m_keys(keys), m_table(detail::hashes_of<Hash>(keys, [](const Key& k) { return k; }),
+                                [&keys](std::size_t i, std::size_t j) { return KeyEqual{}(keys[i], keys[j]); }) {
+    }
+
+    constexpr const_iterator begin() const noexcept {
+        return m_keys.data();
+    }
+    constexpr const_iterator end() const noexcept {
+        return m_keys.data() + N;
+    }
+    constexpr size_type size() const noexcept {
+        return N;
+    }
+    constexpr bool empty() const noexcept {
+        return N == 0;
+    }
+
+    template <typename K>
+    constexpr const_iterator find(const K& key) const {
+        const auto i = m_table.index(Hash{}(key));
+        return i != N && KeyEqual{}(m_keys[i], key) ? begin() + i : end();
+    }
+    template <typename K>
+    constexpr bool contains(const K& key) const {
+        return find(key) != end();
+    }
+    template <typename K>
+    constexpr size_type count(const K& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+private:
+    std::array<Key, N> m_keys;
+    detail::perfect_hash_table<N> m_table;
+};
+
+// constexpr auto fields = make_static_map<std::string_view, int>({{"id", 1}, {"name", 2}});
+template <typename Key, typename Value, typename Hash = static_hash, typename KeyEqual = std::equal_to<>, std::size_t N>
+constexpr auto make_static_map(const std::pair<Key, Value> (&items)[N]) {
+    return static_map<Key, Value, N, Hash, KeyEqual>(detail::to_array(items, std::make_index_sequence<N>{}));
+}
+
+// constexpr auto keywords = make_static_set<std::string_view>({"if", "else", "while"});
+template <typename Key, typename Hash = static_hash, typename KeyEqual = std::equal_to<>, std::size_t N>
+constexpr auto make_static_set(const Key (&keys)[N]) {
+    return static_set<Key, N, Hash, KeyEqual>(detail::to_array(keys, std::make_index_sequence<N>{}));
+}
+} // namespace mleivo::cu
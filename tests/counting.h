@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+// instrumentation for asserting on the work the utilities do: counted is an element type that counts its copies and
+// moves, counting_allocator counts the allocations of a container, and with tests/counting.cpp linked in every global
+// operator new is counted as well. snapshot the counts before a call and look at delta() after it
+namespace counting {
+struct counts {
+    std::size_t copies = 0;
+    std::size_t moves = 0;
+    std::size_t allocations = 0;           // global operator new
+    std::size_t allocator_allocations = 0; // counting_allocator
+
+    friend counts operator-(const counts& lhs, const counts& rhs) {
+        return {lhs.copies - rhs.copies, lhs.moves - rhs.moves, lhs.allocations - rhs.allocations,
+                lhs.allocator_allocations - rhs.allocator_allocations};
+    }
+};
+
+struct counters {
+    std::atomic<std::size_t> copies{0};
+    std::atomic<std::size_t> moves{0};
+    std::atomic<std::size_t> allocations{0};
+    std::atomic<std::size_t> allocator_allocations{0};
+
+    counts load() const {
+        return {copies.load(), moves.load(), allocations.load(), allocator_allocations.load()};
+    }
+};
+
+inline counters& global() {
+    static counters c;
+    return c;
+}
+
+class snapshot {
+public:
+    snapshot() : m_start(global().load()) {
+    }
+
+    counts delta() const {
+        return global().load() - m_start;
+    }
+
+private:
+    counts m_start;
+};
+
+struct counted {
+    counted() = default;
+    explicit counted(int val) : m_val(val) {
+    }
+    counted(const counted& rhs) : m_val(rhs.m_val) {
+        ++global().copies;
+    }
+    counted(counted&& rhs) noexcept : m_val(rhs.m_val) {
+        ++global().moves;
+    }
+    counted& operator=(const counted& rhs) {
+        m_val = rhs.m_val;
+        ++global().copies;
+        return *this;
+    }
+    counted& operator=(counted&& rhs) noexcept {
+        m_val = rhs.m_val;
+        ++global().moves;
+        return *this;
+    }
+
+    int m_val = 0;
+
+    friend bool operator==(const counted& lhs, const counted& rhs) {
+        return lhs.m_val == rhs.m_val;
+    }
+    friend bool operator!=(const counted& lhs, const counted& rhs) {
+        return !(lhs == rhs);
+    }
+    friend bool operator<(const counted& lhs, const counted& rhs) {
+        return lhs.m_val < rhs.m_val;
+    }
+};
+
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() = default;
+    template <typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept {
+    }
+
+    T* allocate(std::size_t n) {
+        ++global().allocator_allocations;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, std::size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    friend bool operator==(const counting_allocator&, const counting_allocator&) {
+        return true;
+    }
+    friend bool operator!=(const counting_allocator&, const counting_allocator&) {
+        return false;
+    }
+};
+} // namespace counting
+
+namespace std {
+template <>
+struct hash<counting::counted> {
+    std::size_t operator()(const counting::counted& c) const noexcept {
+        return std::hash<int>()(c.m_val);
+    }
+};
+} // namespace std
@@ -1,6 +1,16 @@
 #include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cstdint>
 #include <deque>
+#include <execution>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <memory>
+#include <numeric>
 #include <set>
+#include <string>
 #include <type_traits>
 
 #include "containerutils.h"
@@ -168,6 +178,46 @@ TEST_CASE("test_enumerate()", "container utils") {
     }
 }
 
+TEST_CASE("test_for_each_enumerated()", "container utils") {
+    {
+        auto v = std::vector<int>(100'000);
+        auto e = mleivo::cu::enumerate(v);
+        using iter_t = decltype(e.begin());
+        // the iterators stash their value, so they are input iterators even over a vector
+        static_assert(std::is_same_v<std::iterator_traits<iter_t>::iterator_category, std::input_iterator_tag>);
+
+        mleivo::cu::for_each_enumerated(v, [](std::size_t i, int& x) { x = static_cast<int>(i * 2); });
+        auto expected = std::vector<int>(v.size());
+        for (std::size_t i = 0; i < expected.size(); ++i)
+            expected[i] = static_cast<int>(i * 2);
+        REQUIRE(expected == v);
+
+        // one index per piece, counted in the narrow index type
+        auto indices = std::vector<std::uint32_t>(v.size());
+        mleivo::cu::for_each_enumerated<std::uint32_t>(
+            indices,
+            [](auto i, std::uint32_t& x) {
+                static_assert(std::is_same_v<decltype(i), std::uint32_t>);
+                x = i;
+            },
+            1);
+        REQUIRE(std::uint32_t{99'999} == indices.back());
+        REQUIRE(static_cast<std::uint64_t>(99'999) * 100'000 / 2
+                == std::accumulate(indices.begin(), indices.end(), std::uint64_t{0}));
+    }
+    {
+        auto l = std::list<char>{'a', 'b', 'c'};
+        auto e = mleivo::cu::enumerate<std::uint8_t>(l);
+        for (auto&& [i, c] : e) {
+            static_assert(std::is_same_v<std::remove_cv_t<std::remove_reference_t<decltype(i)>>, std::uint8_t>);
+            REQUIRE('a' + i == c);
+        }
+        auto [i, c] = *std::next(e.begin(), 2);
+        REQUIRE(2 == i);
+        REQUIRE('c' == c);
+    }
+}
+
 TEST_CASE("test_remove_all()", "[container utils]") {
     {
         std::vector<int> v{1, 2, 1, 2, 1};
@@ -271,6 +321,19 @@ TEST_CASE("test_static_cast_all()", "[container utils]") {
             delete d;
         }
     }
+    {
+        auto v = std::vector<double>{-1e10, -1.5, 0, 1.5, 1e10};
+        auto ints = mleivo::cu::static_cast_all<int>(v, mleivo::cu::saturate);
+        REQUIRE(ints == std::vector<int>{std::numeric_limits<int>::min(), -1, 0, 1, std::numeric_limits<int>::max()});
+
+        auto list = std::list<double>{-1e10, 1e10};
+        auto clamped = mleivo::cu::static_cast_all<int>(list, mleivo::cu::saturate);
+        REQUIRE(clamped == std::list<int>{std::numeric_limits<int>::min(), std::numeric_limits<int>::max()});
+
+        std::array<std::int64_t, 2> wide = {std::numeric_limits<std::int64_t>::min(), 7};
+        auto narrow = mleivo::cu::static_cast_all<std::int32_t>(wide, mleivo::cu::saturate);
+        REQUIRE(narrow == std::array<std::int32_t, 2>{std::numeric_limits<std::int32_t>::min(), 7});
+    }
 }
 
 TEST_CASE("test_contains()", "container utils") {
@@ -364,6 +427,64 @@ TEST_CASE("test_merge()", "container utils") {
             REQUIRE(i == merged[i].m_val);
         }
     }
+
+    {
+        const auto v1 = std::array<int, 2>{0, 1};
+        const auto v2 = std::vector<int>{};
+        auto v3 = std::vector<int>{2, 3, 4};
+        const auto merged = mleivo::cu::merge(v1, v2, std::move(v3), std::list<int>{5});
+        REQUIRE(merged == std::vector<int>{0, 1, 2, 3, 4, 5});
+        REQUIRE(merged.capacity() == merged.size());
+    }
+}
+
+TEST_CASE("test_merge_sorted()", "container utils") {
+    {
+        const auto shards = std::vector<std::vector<int>>{{1, 4, 9}, {}, {2, 3, 10, 11}, {0}, {4, 5}};
+        const auto merged = mleivo::cu::merge_sorted(shards);
+        REQUIRE(merged == std::vector<int>{0, 1, 2, 3, 4, 4, 5, 9, 10, 11});
+    }
+    {
+        // stable: equal elements keep the order of their sources
+        using pair_t = std::pair<int, char>;
+        auto first_only = [](const pair_t& lhs, const pair_t& rhs) { return lhs.first < rhs.first; };
+        const auto shards = std::vector<std::list<pair_t>>{{{1, 'a'}, {2, 'a'}}, {{1, 'b'}}, {{0, 'c'}, {2, 'c'}}};
+        const auto merged = mleivo::cu::merge_sorted(shards, first_only);
+        REQUIRE(merged == std::vector<pair_t>{{0, 'c'}, {1, 'a'}, {1, 'b'}, {2, 'a'}, {2, 'c'}});
+    }
+    {
+        auto shards = std::vector<std::deque<move_only_type>>(3);
+        for (int i = 0; i < 30; ++i)
+            shards[i % 3].emplace_back(i);
+        const auto merged = mleivo::cu::merge_sorted(std::move(shards));
+        REQUIRE(30 == merged.size());
+        for (int i = 0; i < 30; ++i)
+            REQUIRE(i == *merged[i].m_val);
+    }
+    {
+        const auto a = std::vector<int>{1, 3, 5};
+        auto b = std::vector<int>{2, 6};
+        REQUIRE(mleivo::cu::merge_sorted(a, b, std::vector<int>{4}) == std::vector<int>{1, 2, 3, 4, 5, 6});
+        const auto descending = std::vector<int>{5, 3, 1};
+        REQUIRE(mleivo::cu::merge_sorted(descending, std::vector<int>{6, 2}, std::greater<>{})
+                == std::vector<int>{6, 5, 3, 2, 1});
+    }
+    {
+        // rvalue arguments are moved from
+        auto a = std::vector<std::unique_ptr<int>>{};
+        auto b = std::vector<std::unique_ptr<int>>{};
+        for (int i = 0; i < 6; ++i)
+            (i % 2 == 0 ? a : b).push_back(std::make_unique<int>(i));
+        const auto by_value = [](const auto& lhs, const auto& rhs) { return *lhs < *rhs; };
+        const auto merged = mleivo::cu::merge_sorted(std::move(a), std::move(b), by_value);
+        REQUIRE(6 == merged.size());
+        for (int i = 0; i < 6; ++i)
+            REQUIRE(i == *merged[i]);
+    }
+    {
+        auto shards = std::vector<std::vector<int>>{};
+        REQUIRE(mleivo::cu::merge_sorted(shards).empty());
+    }
 }
 
 TEST_CASE("test_filter()", "container utils") {
@@ -547,7 +668,16 @@ TEST_CASE("test_to_std_vector()", "container utils") {
 TEST_CASE("test_compile_time_map()", "container utils") {
     using my_type_map = mleivo::type_traits::type_map<int, char, double, float>;
     static_assert(std::is_same_v<my_type_map::value<int>, char>);
+    static_assert(std::is_same_v<my_type_map::value<double>, float>);
     //    static_assert(std::is_same_v<my_type_map::value<bool>, char>);
+    static_assert(std::is_same_v<my_type_map::value<bool>, std::enable_if<false>>);
+    // values are not keys, and the first of repeated keys wins
+    using repeated = mleivo::type_traits::type_map<int, double, double, char, int, bool>;
+    static_assert(std::is_same_v<repeated::value<double>, char>);
+    static_assert(std::is_same_v<repeated::value<int>, double>);
+    static_assert(std::is_same_v<mleivo::type_traits::nth_type<2, int, char, bool>, bool>);
+    static_assert(mleivo::type_traits::value_types_equal_v<std::vector<int>, std::list<int>, const std::deque<int>&>);
+    static_assert(!mleivo::type_traits::value_types_equal_v<std::vector<int>, std::vector<long>>);
 }
 
 TEST_CASE("test_transform()", "container utils") {
@@ -597,6 +727,105 @@ TEST_CASE("test_transform()", "container utils") {
             REQUIRE(i == out[i]);
         }
     }
+    {
+        auto in = std::vector<int>{0, 1, 2, 3};
+        const auto* buffer = in.data();
+        auto out = mleivo::cu::transform(std::move(in), [](int i) { return i * i; });
+        REQUIRE(buffer == out.data());
+        REQUIRE(true == cmp(std::vector<int>{0, 1, 4, 9}, out));
+    }
+    {
+        auto out = mleivo::cu::transform(std::vector<bool>{true, false, false}, [](bool b) { return !b; });
+        static_assert(std::is_same_v<decltype(out), std::vector<bool>>);
+        REQUIRE(std::vector<bool>{false, true, true} == out);
+    }
+    {
+        const auto in = std::vector<int>{0, 1, 2, 3};
+        auto out = mleivo::cu::transform(in, [](int i) { return i * 0.5; });
+        static_assert(std::is_same_v<decltype(out), std::vector<double>>);
+        REQUIRE(true == cmp(std::vector<int>{0, 1, 2, 3}, in));
+        REQUIRE(true == cmp(std::vector<double>{0.0, 0.5, 1.0, 1.5}, out));
+    }
+    {
+        auto in = std::set<int>{0, 1, 2, 3};
+        auto out = mleivo::cu::transform(in, [](int i) { return std::to_string(i); });
+        REQUIRE(true == cmp(std::vector<std::string>{"0", "1", "2", "3"}, out));
+    }
+}
+
+TEST_CASE("test_into()", "container utils") {
+    using namespace mleivo;
+    {
+        auto out = std::vector<int>{};
+        out.reserve(8);
+        const auto* buffer = out.data();
+        for (int batch = 0; batch < 3; ++batch) {
+            out.clear();
+            cu::filter_into(out, std::vector<int>{2 * batch + 1, 2, 3, 4}, [](int i) { return i % 2 == 0; });
+            cu::transform_into(out, std::list<int>{5, 6}, [](int i) { return i * 10; });
+            REQUIRE(buffer == out.data());
+        }
+        REQUIRE(true == cmp(std::vector<int>{2, 4, 50, 60}, out));
+
+        auto& same = cu::merge_into(out, std::vector<int>{7}, std::deque<int>{8, 9});
+        REQUIRE(&same == &out);
+        REQUIRE(true == cmp(std::vector<int>{2, 4, 50, 60, 7, 8, 9}, out));
+    }
+    {
+        auto in = std::vector<move_only_type>{};
+        in.emplace_back(1);
+        in.emplace_back(2);
+        auto out = std::vector<move_only_type>{};
+        cu::filter_into(out, std::move(in), [](const move_only_type& i) { return *i.m_val == 2; });
+        auto rest = std::vector<move_only_type>{};
+        rest.emplace_back(1);
+        cu::merge_into(out, std::move(rest));
+        REQUIRE(2 == out.size());
+        REQUIRE(2 == *out[0].m_val);
+        REQUIRE(1 == *out[1].m_val);
+    }
+    {
+        const auto in = std::vector<int>{1, 2, 3, 4};
+        auto out = std::array<int, 6>{};
+        auto it = cu::filter_into(out.begin(), in, [](int i) { return i > 2; });
+        it = cu::transform_into(it, in, [](int i) { return -i; });
+        REQUIRE(out.end() == it);
+        REQUIRE(true == cmp(std::array<int, 6>{3, 4, -1, -2, -3, -4}, out));
+
+        auto l = std::list<int>{};
+        cu::merge_into(std::back_inserter(l), in, std::vector<int>{0});
+        REQUIRE((std::list<int>{1, 2, 3, 4, 0} == l));
+    }
+    {
+        const auto in = std::vector<double>{1.5, -1e10, 300.0};
+        auto out = std::vector<std::int16_t>{7};
+        cu::static_cast_all_into(out, in, cu::saturate);
+        REQUIRE(true == cmp(std::vector<std::int16_t>{7, 1, -32768, 300}, out));
+
+        auto raw = std::array<std::uint8_t, 3>{};
+        REQUIRE(raw.data() + 3 == cu::static_cast_all_into(raw.data(), in, cu::saturate));
+        REQUIRE(true == cmp(std::array<std::uint8_t, 3>{1, 0, 255}, raw));
+
+        auto longs = std::vector<long>{};
+        cu::static_cast_all_into<long>(std::back_inserter(longs), std::list<int>{4, 5});
+        REQUIRE(true == cmp(std::vector<long>{4, 5}, longs));
+    }
+    {
+        auto out = std::vector<std::string>{"x"};
+        cu::split_into(out, std::string("ab,c"), ',');
+        REQUIRE(true == cmp(std::vector<std::string>{"x", "ab", "c"}, out));
+
+        auto pieces = std::vector<std::string>(4, std::string(32, '-'));
+        const auto* storage = pieces[1].data();
+        auto last = cu::split_into(pieces.begin(), std::string("a,bb,"), ',');
+        REQUIRE(3 == last - pieces.begin());
+        REQUIRE(true == cmp(std::vector<std::string>{"a", "bb", "", std::string(32, '-')}, pieces));
+        REQUIRE(storage == pieces[1].data()); // refilled in place
+
+        auto l = std::list<std::string>{};
+        cu::split_into(std::back_inserter(l), std::string(",z"), ',');
+        REQUIRE((std::list<std::string>{"", "z"} == l));
+    }
 }
 
 TEST_CASE("test_cont()", "container utils") {
@@ -634,11 +863,39 @@ TEST_CASE("test_any_of()", "container utils") {
 }
 
 TEST_CASE("test_remove_duplicates()", "container utils") {
-    std::vector<int> v{0, 1, 0, 1, 2, 2, 2, 3, 2, 2};
-    mleivo::cu::remove_duplicates(v);
-    REQUIRE(4 == v.size());
-    for (int i = 0; i < v.size(); ++i) {
-        REQUIRE(i == v[i]);
+    {
+        std::vector<int> v{0, 1, 0, 1, 2, 2, 2, 3, 2, 2};
+        mleivo::cu::remove_duplicates(v);
+        REQUIRE(4 == v.size());
+        for (int i = 0; i < v.size(); ++i) {
+            REQUIRE(i == v[i]);
+        }
+    }
+    {
+        std::deque<std::string> v{"b", "a", "b", "c", "a"};
+        mleivo::cu::remove_duplicates(v);
+        REQUIRE(true == cmp(std::deque<std::string>{"b", "a", "c"}, v));
+    }
+    {
+        std::vector<move_only_type> v;
+        for (auto i : {3, 1, 3, 0, 1, 2, 0})
+            v.emplace_back(i);
+        mleivo::cu::remove_duplicates(v);
+        REQUIRE(4 == v.size());
+        REQUIRE(3 == *v[0].m_val);
+        REQUIRE(1 == *v[1].m_val);
+        REQUIRE(0 == *v[2].m_val);
+        REQUIRE(2 == *v[3].m_val);
+    }
+    {
+        std::vector<int> v{1, -1, 2, -2, 1, 3};
+        mleivo::cu::remove_duplicates(v, [](int lhs, int rhs) { return std::abs(lhs) == std::abs(rhs); });
+        REQUIRE(true == cmp(std::vector<int>{1, 2, 3}, v));
+    }
+    {
+        std::vector<bool> v{true, true, false, true, false};
+        mleivo::cu::remove_duplicates(v);
+        REQUIRE(true == cmp(std::vector<bool>{true, false}, v));
     }
 }
 
@@ -705,3 +962,97 @@ TEST_CASE("test_irange()", "container utils") {
         }
     }
 }
+
+TEST_CASE("test_irange_random_access()", "container utils") {
+    {
+        const auto r = mleivo::cu::irange(0, 10, 3);
+        using iter_t = decltype(r.begin());
+        static_assert(std::is_same_v<std::iterator_traits<iter_t>::iterator_category, std::random_access_iterator_tag>);
+        REQUIRE(4 == r.size());
+        REQUIRE(4 == r.end() - r.begin());
+        REQUIRE(9 == r[3]);
+        REQUIRE(6 == r.begin()[2]);
+        REQUIRE(9 == *(r.end() - 1));
+        REQUIRE(std::vector<int>{3, 6} == std::vector<int>(r.begin() + 1, r.begin() + 3));
+    }
+    {
+        REQUIRE(0 == mleivo::cu::irange(0, 0, 1).size());
+        REQUIRE(0 == mleivo::cu::irange(5, 0, 1).size());
+        REQUIRE(0 == mleivo::cu::irange(0, 5, -1).size());
+        REQUIRE(5 == mleivo::cu::irange(5, 0, -1).size());
+        REQUIRE(7 == mleivo::cu::irange(10, -10, -3).size());
+        REQUIRE(5 == mleivo::cu::irange(2u, 11u, 2u).size());
+    }
+    {
+        // spanning the whole of the type must not overflow
+        constexpr auto lo = std::numeric_limits<std::int8_t>::min();
+        constexpr auto hi = std::numeric_limits<std::int8_t>::max();
+        const auto r = mleivo::cu::irange<std::int8_t>(lo, hi, 100);
+        REQUIRE(3 == r.size());
+        REQUIRE(std::vector<std::int8_t>{lo, -28, 72} == std::vector<std::int8_t>(r.begin(), r.end()));
+        const auto down = mleivo::cu::irange<std::int8_t>(hi, lo, -128);
+        REQUIRE(2 == down.size());
+        REQUIRE(-1 == down[1]);
+    }
+    {
+        const auto r = mleivo::cu::irange(0, 1000, 1);
+        const auto sum = std::reduce(std::execution::par, r.begin(), r.end(), 0LL);
+        REQUIRE(499500 == sum);
+        REQUIRE(sum == std::accumulate(r.begin(), r.end(), 0LL));
+
+        auto chunked = 0LL;
+        for (std::size_t first = 0; first < r.size(); first += 300) {
+            const auto chunk = r.slice(first, std::min(first + 300, r.size()));
+            chunked += std::transform_reduce(std::execution::par, chunk.begin(), chunk.end(), 0LL, std::plus<>{},
+                                             [](int i) { return static_cast<long long>(i); });
+        }
+        REQUIRE(sum == chunked);
+        REQUIRE(r.slice(5, 5).empty());
+    }
+}
+
+TEST_CASE("test_split_view()", "container utils") {
+    {
+        const auto s = std::string("a,bc,,d,");
+        auto out = mleivo::cu::to_std_vector(mleivo::cu::split_view(s, ','));
+        static_assert(std::is_same_v<decltype(out), std::vector<std::string_view>>);
+        REQUIRE(true == cmp(std::vector<std::string_view>{"a", "bc", "", "d", ""}, out));
+        REQUIRE(out[1].data() == s.data() + 2);
+    }
+    {
+        auto out = mleivo::cu::to_std_vector(mleivo::cu::split_view(std::string_view("key: value: x"), ": "));
+        REQUIRE(true == cmp(std::vector<std::string_view>{"key", "value", "x"}, out));
+    }
+    {
+        auto out = mleivo::cu::to_std_vector(mleivo::cu::split_view(std::string_view(""), ','));
+        REQUIRE(1 == out.size());
+        REQUIRE(out[0].empty());
+    }
+    {
+        auto v = std::vector<int>{};
+        for (int i = 0; i < 40; ++i)
+            v.push_back(i % 10 == 9 ? -1 : i);
+        auto i = 0;
+        for (auto piece : mleivo::cu::split_view(v, -1)) {
+            static_assert(std::is_same_v<decltype(piece), mleivo::cu::span<int>>);
+            if (i < 4) {
+                REQUIRE(9 == piece.size());
+                REQUIRE(i * 10 == piece.front());
+                piece.front() = 0;
+            } else {
+                REQUIRE(piece.empty());
+            }
+            ++i;
+        }
+        REQUIRE(5 == i);
+        REQUIRE(0 == v[10]);
+    }
+    {
+        const auto v = std::vector<std::int64_t>{1, 2, 0, 3, 4, 5, 0};
+        auto out = mleivo::cu::to_std_vector(mleivo::cu::split_view(v, 0));
+        REQUIRE(3 == out.size());
+        REQUIRE(true == cmp(std::vector<std::int64_t>{1, 2}, out[0]));
+        REQUIRE(true == cmp(std::vector<std::int64_t>{3, 4, 5}, out[1]));
+        REQUIRE(out[2].empty());
+    }
+}
@@ -0,0 +1,291 @@
+#include <catch2/catch_test_macros.hpp>
+#include <deque>
+#include <list>
+#include <memory_resource>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "containerutils.h"
+#include "counting.h"
+#include "pipes.h"
+
+// upper bounds on the copies, moves and allocations of each utility, a silent extra copy fails here
+
+using counting::counted;
+
+namespace {
+std::vector<counted> make_counted(int n) {
+    auto out = std::vector<counted>{};
+    out.reserve(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i)
+        out.emplace_back(i);
+    return out;
+}
+} // namespace
+
+TEST_CASE("test_counting_instrumentation()", "[counting]") {
+    auto s = counting::snapshot{};
+    auto a = counted{1};
+    auto b = a;
+    auto c = std::move(a);
+    b = c;
+    c = std::move(b);
+    int* volatile p = new int(1); // volatile so the optimizer can not elide the pair
+    delete p;
+    auto v = std::vector<int, counting::counting_allocator<int>>{};
+    v.reserve(10);
+    const auto d = s.delta();
+    REQUIRE(2 == d.copies);
+    REQUIRE(2 == d.moves);
+    REQUIRE(2 == d.allocations); // counting_allocator allocates with operator new as well
+    REQUIRE(1 == d.allocator_allocations);
+}
+
+TEST_CASE("test_counting_container_utils()", "[counting]") {
+    constexpr auto n = 100;
+    {
+        auto v = make_counted(n);
+        auto s = counting::snapshot{};
+        auto out = mleivo::cu::to_std_vector(std::move(v));
+        REQUIRE(0 == s.delta().copies);
+        REQUIRE(0 == s.delta().moves);
+        REQUIRE(0 == s.delta().allocations);
+        REQUIRE(n == out.size());
+    }
+    {
+        auto d = std::deque<counted>(n);
+        auto s = counting::snapshot{};
+        auto out = mleivo::cu::to_std_vector(std::move(d));
+        REQUIRE(0 == s.delta().copies);
+        REQUIRE(n == s.delta().moves);
+        REQUIRE(1 == s.delta().allocations);
+    }
+    {
+        const auto l = std::list<counted>(n);
+        auto s = counting::snapshot{};
+        auto out = mleivo::cu::to_std_vector(l);
+        REQUIRE(n == s.delta().copies);
+        REQUIRE(0 == s.delta().moves);
+        REQUIRE(1 == s.delta().allocations);
+    }
+    {
+        const auto v = make_counted(n);
+        auto s = counting::snapshot{};
+        auto out = mleivo::cu::filter(v, [](const counted& c) { return c.m_val % 2 == 0; });
+        REQUIRE(n / 2 == s.delta().copies);
+        REQUIRE(0 == s.delta().moves);
+        REQUIRE(1 == s.delta().allocations);
+    }
+    {
+        // a predicate taking its argument by value copies it, but never moves from the container
+        auto v = make_counted(n);
+        auto s = counting::snapshot{};
+        auto out = mleivo::cu::filter(std::move(v), [](counted c) { return c.m_val % 2 == 0; });
+        REQUIRE(n == s.delta().copies);
+        REQUIRE(n / 2 == s.delta().moves);
+        REQUIRE(1 == s.delta().allocations);
+        REQUIRE(out.back().m_val == n - 2);
+    }
+    {
+        auto v1 = make_counted(n);
+        const auto v2 = make_counted(n);
+        auto v3 = std::deque<counted>(n);
+        auto s = counting::snapshot{};
+        auto out = mleivo::cu::merge(std::move(v1), v2, std::move(v3));
+        REQUIRE(n == s.delta().copies);
+        REQUIRE(2 * n == s.delta().moves);
+        REQUIRE(1 == s.delta().allocations);
+    }
+    {
+        auto shards = std::vector<std::vector<counted>>{make_counted(n), make_counted(n), make_counted(n)};
+        auto s = counting::snapshot{};
+        auto out = mleivo::cu::merge_sorted(std::move(shards));
+        REQUIRE(0 == s.delta().copies);
+        REQUIRE(3 * n == s.delta().moves);
+        REQUIRE(3 >= s.delta().allocations); // the output, the sources and the tree
+    }
+    {
+        auto v = make_counted(n);
+        auto s = counting::snapshot{};
+        auto out = mleivo::cu::transform(std::move(v), [](counted&& c) {
+            c.m_val *= 2;
+            return std::move(c);
+        });
+        REQUIRE(0 == s.delta().copies);
+        REQUIRE(2 * n == s.delta().moves); // out of the element and back into it
+        REQUIRE(0 == s.delta().allocations);
+    }
+    {
+        const auto v = make_counted(n);
+        auto s = counting::snapshot{};
+        auto out = mleivo::cu::transform(v, [](const counted& c) { return c.m_val; });
+        REQUIRE(0 == s.delta().copies);
+        REQUIRE(1 == s.delta().allocations);
+    }
+    {
+        auto v = make_counted(n);
+        v.insert(v.end(), v.begin(), v.begin() + n / 2);
+        auto s = counting::snapshot{};
+        mleivo::cu::remove_duplicates(v);
+        REQUIRE(0 == s.delta().copies);
+        REQUIRE(n == v.size());
+    }
+    {
+        const auto v = std::vector<int>(n);
+        auto s = counting::snapshot{};
+        auto out = mleivo::cu::static_cast_all<double>(v);
+        REQUIRE(1 == s.delta().allocations);
+    }
+    {
+        auto v = make_counted(n);
+        auto s = counting::snapshot{};
+        auto sum = 0;
+        for (auto&& [i, c] : mleivo::cu::enumerate(v))
+            sum += c.m_val + static_cast<int>(i);
+        for (auto i : mleivo::cu::irange(0, n, 1))
+            sum += i;
+        REQUIRE(0 == s.delta().copies);
+        REQUIRE(0 == s.delta().moves);
+        REQUIRE(0 == s.delta().allocations);
+    }
+    {
+        const auto v = make_counted(n);
+        const auto separator = counted{50};
+        auto s = counting::snapshot{};
+        auto pieces = 0;
+        for (auto piece : mleivo::cu::split_view(v, separator))
+            pieces += piece.empty() ? 0 : 1;
+        REQUIRE(2 == pieces);
+        REQUIRE(1 == s.delta().copies); // the view keeps its own separator
+        REQUIRE(1 >= s.delta().moves);
+        REQUIRE(0 == s.delta().allocations);
+    }
+    {
+        auto r = mleivo::cu::ring_buffer<counted>(n);
+        auto s = counting::snapshot{};
+        for (int i = 0; i < n; ++i)
+            r.emplace_back(i);
+        while (!r.empty())
+            mleivo::cu::pop_front(r);
+        REQUIRE(0 == s.delta().copies);
+        REQUIRE(0 == s.delta().moves);
+        REQUIRE(0 == s.delta().allocations);
+    }
+}
+
+TEST_CASE("test_counting_allocator_overloads()", "[counting]") {
+    using namespace mleivo;
+    const auto in = std::vector<int>{5, 0, 3, 0, 1, 4};
+    const auto list = std::list<int>(in.begin(), in.end());
+    const auto seven = std::vector<int>{7};
+    std::byte buffer[4096];
+    auto arena = std::pmr::monotonic_buffer_resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    auto s = counting::snapshot{};
+
+    const std::pmr::vector<int> odd = cu::filter(std::allocator_arg, &arena, in, [](int i) { return i % 2 == 1; });
+    REQUIRE(odd == std::pmr::vector<int>{5, 3, 1});
+    const std::pmr::vector<int> merged = cu::merge(std::allocator_arg, &arena, in, seven, odd);
+    REQUIRE(merged == std::pmr::vector<int>{5, 0, 3, 0, 1, 4, 7, 5, 3, 1});
+    const std::pmr::vector<double> halves = cu::transform(std::allocator_arg, &arena, in, [](int i) { return i / 2.; });
+    REQUIRE(halves == std::pmr::vector<double>{2.5, 0, 1.5, 0, .5, 2});
+    const std::pmr::vector<short> shorts = cu::static_cast_all<short>(std::allocator_arg, &arena, in);
+    REQUIRE(shorts == std::pmr::vector<short>{5, 0, 3, 0, 1, 4});
+    const std::pmr::vector<int> copy = cu::to_std_vector(std::allocator_arg, &arena, list);
+    REQUIRE(copy == std::pmr::vector<int>(in.begin(), in.end()));
+    const auto text = std::pmr::string("a long enough first piece,b", &arena);
+    const auto pieces = cu::split(std::allocator_arg, &arena, text, ',');
+    REQUIRE(2 == pieces.size());
+    REQUIRE(pieces[0] == "a long enough first piece");
+    REQUIRE(pieces[0].get_allocator().resource() == &arena); // uses-allocator construction reaches the pieces
+    REQUIRE(pieces[1] == "b");
+    REQUIRE(0 == s.delta().allocations); // everything above lives in buffer
+
+    auto alloc = counting::counting_allocator<int>{};
+    s = counting::snapshot{};
+    const auto counted_out = cu::filter(std::allocator_arg, alloc, in, [](int i) { return i > 0; });
+    static_assert(std::is_same_v<const std::vector<int, counting::counting_allocator<int>>, decltype(counted_out)>);
+    REQUIRE(4 == counted_out.size());
+    REQUIRE(1 == s.delta().allocator_allocations);
+}
+
+TEST_CASE("test_counting_into()", "[counting]") {
+    using namespace mleivo;
+    constexpr auto n = 100;
+    auto in = make_counted(n);
+    auto out = std::vector<counted>{};
+    auto values = std::vector<int>{};
+    cu::filter_into(out, in, [](const counted& e) { return e.m_val % 2 == 0; });
+    cu::transform_into(values, in, [](const counted& e) { return e.m_val; });
+    auto s = counting::snapshot{};
+    for (int batch = 0; batch < 10; ++batch) { // the buffers of the first batch are reused
+        out.clear();
+        values.clear();
+        cu::filter_into(out, in, [](const counted& e) { return e.m_val % 2 == 0; });
+        cu::transform_into(values, in, [](const counted& e) { return e.m_val; });
+    }
+    REQUIRE(10 * n / 2 == s.delta().copies);
+    REQUIRE(0 == s.delta().moves);
+    REQUIRE(0 == s.delta().allocations);
+    REQUIRE(n / 2 == out.size());
+}
+
+TEST_CASE("test_counting_small_vector()", "[counting]") {
+    using namespace mleivo;
+    const auto in = make_counted(100);
+    auto s = counting::snapshot{};
+    const auto few = cu::filter<cu::small_vector<counted, 16>>(in, [](const counted& e) { return e.m_val < 10; });
+    REQUIRE(0 == s.delta().allocations); // no reserve for all 100 while the results fit inline
+    REQUIRE(10 == s.delta().copies);
+    REQUIRE(10 == few.size());
+}
+
+TEST_CASE("test_counting_pipes()", "[counting]") {
+    constexpr auto n = 100;
+    {
+        auto v = make_counted(n);
+        std::reverse(v.begin(), v.end());
+        auto s = counting::snapshot{};
+        auto sorted = std::move(v) | mleivo::pipes::sort();
+        REQUIRE(0 == s.delta().copies);
+        REQUIRE(0 == s.delta().allocations);
+        REQUIRE(0 == sorted.front().m_val);
+    }
+    {
+        const auto v = make_counted(n);
+        auto s = counting::snapshot{};
+        auto found = v | mleivo::pipes::find(counted{n / 2});
+        auto count = v | mleivo::pipes::count_if([](const counted& c) { return c.m_val < 10; });
+        REQUIRE(0 == s.delta().copies);
+        REQUIRE(0 == s.delta().allocations);
+        REQUIRE(n / 2 == found->m_val);
+        REQUIRE(10 == count);
+    }
+    {
+        const auto v = make_counted(n);
+        auto s = counting::snapshot{};
+        auto out = v | mleivo::pipes::filter([](const counted& c) { return c.m_val % 2 == 0; })
+                   | mleivo::pipes::to<std::vector<counted>>();
+        REQUIRE(n / 2 == s.delta().copies);
+        REQUIRE(n / 2 == out.size());
+    }
+    {
+        // temporary stages move their callables into the views, a named one copies its own. The iterators then
+        // carry copies of them
+        auto v = std::vector<int>(n);
+        std::iota(v.begin(), v.end(), 0);
+        auto s = counting::snapshot{};
+        auto view = v | mleivo::pipes::filter([k = counted{2}](int i) { return i % k.m_val == 0; })
+                    | mleivo::pipes::transform([k = counted{3}](int i) { return i * k.m_val; });
+        REQUIRE(0 == s.delta().copies);
+        auto out = std::move(view) | mleivo::pipes::to<std::vector<int>>();
+        REQUIRE(n / 2 == out.size());
+        REQUIRE(3 * (n - 2) == out.back());
+
+        const auto odd = mleivo::pipes::filter([k = counted{2}](int i) { return i % k.m_val == 1; });
+        s = counting::snapshot{};
+        auto odd_view = v | odd;
+        REQUIRE(1 == s.delta().copies);
+        REQUIRE(n / 2 == (std::move(odd_view) | mleivo::pipes::count_if([](int) { return true; })));
+    }
+}
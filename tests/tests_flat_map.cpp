@@ -0,0 +1,174 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "containerutils.h"
+#include "flat_map.h"
+#include "helpers.h"
+
+TEST_CASE("test_branchless_lower_bound()", "[flat map]") {
+    auto rng = std::mt19937(7);
+    for (std::size_t n = 0; n < 40; ++n) {
+        auto v = std::vector<int>(n);
+        for (auto& e : v)
+            e = static_cast<int>(rng() % 16);
+        std::sort(v.begin(), v.end());
+        for (int key = -1; key < 18; ++key) {
+            const auto lower = mleivo::cu::detail::branchless_lower_bound(v.data(), n, key, std::less<>{});
+            const auto upper = mleivo::cu::detail::branchless_upper_bound(v.data(), n, key, std::less<>{});
+            REQUIRE(std::lower_bound(v.begin(), v.end(), key) - v.begin() == lower - v.data());
+            REQUIRE(std::upper_bound(v.begin(), v.end(), key) - v.begin() == upper - v.data());
+        }
+    }
+}
+
+TEST_CASE("test_flat_set()", "[flat map]") {
+    using mleivo::cu::flat_set;
+    {
+        auto s = flat_set<int>{5, 1, 3, 1, 9};
+        REQUIRE(true == cmp(s.keys(), std::vector<int>{1, 3, 5, 9}));
+        REQUIRE(s.contains(3));
+        REQUIRE(!s.contains(4));
+        REQUIRE(1 == s.count(9));
+        REQUIRE(5 == *s.lower_bound(4));
+        REQUIRE(s.end() == s.find(10));
+
+        REQUIRE(!s.insert(3).second);
+        REQUIRE(s.insert(4).second);
+        s.insert({12, 0, 5, 11, 0});
+        REQUIRE(true == cmp(s.keys(), std::vector<int>{0, 1, 3, 4, 5, 9, 11, 12}));
+
+        REQUIRE(1 == s.erase(4));
+        REQUIRE(0 == s.erase(4));
+        REQUIRE(2 == s.erase_if([](int i) { return i > 10; }));
+        REQUIRE(true == cmp(s.keys(), std::vector<int>{0, 1, 3, 5, 9}));
+    }
+    {
+        // of equivalent keys the one already in the set, or else the first of the batch, is kept
+        const auto by_length = [](const std::string& l, const std::string& r) { return l.size() < r.size(); };
+        auto s = flat_set<std::string, decltype(by_length)>({"bb"}, by_length);
+        s.insert({"ccc", "x", "aa", "yyy", "z"});
+        REQUIRE(true == cmp(s.keys(), std::vector<std::string>{"x", "bb", "ccc"}));
+    }
+    {
+        auto a = flat_set<int>(mleivo::cu::sorted_unique, {1, 4, 7});
+        const auto b = flat_set<int>{2, 4, 8};
+        a.merge(b);
+        a.merge(a);
+        REQUIRE(true == cmp(a.keys(), std::vector<int>{1, 2, 4, 7, 8}));
+        REQUIRE(a < b);
+        REQUIRE(true == cmp(std::move(a).extract(), std::vector<int>{1, 2, 4, 7, 8}));
+    }
+}
+
+TEST_CASE("test_flat_map()", "[flat map]") {
+    using mleivo::cu::flat_map;
+    {
+        auto m = flat_map<std::string, int>{{"b", 2}, {"a", 1}, {"c", 3}, {"a", 10}};
+        REQUIRE(3 == m.size());
+        REQUIRE(true == cmp(m.keys(), std::vector<std::string>{"a", "b", "c"}));
+        REQUIRE(true == cmp(m.values(), std::vector<int>{1, 2, 3}));
+        REQUIRE(m.contains("b"));
+        REQUIRE(!m.contains("d"));
+        REQUIRE(2 == m.at("b"));
+        REQUIRE_THROWS_AS(m.at("d"), std::out_of_range);
+
+        m["d"] = 4;
+        m["a"] += 10;
+        REQUIRE(11 == m.find("a")->second);
+        REQUIRE(!m.try_emplace("d", 40).second);
+        REQUIRE(!m.insert_or_assign("d", 40).second);
+        REQUIRE(40 == m.at("d"));
+
+        auto keys = std::string{};
+        auto sum = 0;
+        for (auto [key, value] : m) {
+            keys += key;
+            sum += value;
+        }
+        REQUIRE("abcd" == keys);
+        REQUIRE(11 + 2 + 3 + 40 == sum);
+
+        REQUIRE(1 == m.erase("c"));
+        REQUIRE(1 == m.erase_if([](const auto& kv) { return kv.second > 20; }));
+        REQUIRE(true == cmp(m.keys(), std::vector<std::string>{"a", "b"}));
+        REQUIRE(true == cmp(m.values(), std::vector<int>{11, 2}));
+    }
+    {
+        auto m = flat_map<int, std::string>{{1, "one"}, {5, "five"}};
+        m.insert({{3, "three"}, {9, "nine"}, {5, "FIVE"}, {0, "zero"}});
+        REQUIRE(true == cmp(m.keys(), std::vector<int>{0, 1, 3, 5, 9}));
+        REQUIRE("five" == m.at(5));
+        m.insert({{10, "ten"}, {11, "eleven"}}); // past the last key, appended
+        REQUIRE(true == cmp(m.values(),
+                            std::vector<std::string>{"zero", "one", "three", "five", "nine", "ten", "eleven"}));
+
+        const auto batch = std::vector<std::pair<int, std::string>>{{2, "two"}, {3, "drei"}};
+        m.insert(mleivo::cu::sorted_unique, batch.begin(), batch.end());
+        REQUIRE("two" == batch[0].second); // copied, not moved from
+        REQUIRE("three" == m.at(3));
+        REQUIRE(8 == m.size());
+        REQUIRE(m.upper_bound(3) == m.lower_bound(5));
+        REQUIRE(std::is_sorted(m.keys().begin(), m.keys().end()));
+    }
+    {
+        // the values of a map to flags are a std::vector<bool>, reached through its proxy references
+        auto m = flat_map<int, bool>{{4, false}, {1, true}};
+        m[2] = true;
+        REQUIRE(m.contains(2));
+        REQUIRE(false == m.at(4));
+        for (auto [k, flag] : m)
+            flag = k % 2 == 0;
+        REQUIRE(true == cmp(m.values(), std::vector<bool>{false, true, true}));
+        m.find(1)->second = true;
+        REQUIRE(0 == m.erase_if([](const auto& kv) { return !kv.second; }));
+        const auto& c = m;
+        REQUIRE(true == c.at(1));
+        REQUIRE_THROWS_AS(c.at(3), std::out_of_range);
+    }
+}
+
+TEST_CASE("test_flat_container_utils()", "[flat map]") {
+    using namespace mleivo;
+    {
+        auto s = cu::flat_set<int>{1, 2, 3, 4};
+        REQUIRE(cu::contains(s, 3));
+        REQUIRE(!cu::contains(s, 7));
+        cu::remove_all(s, 2);
+        cu::remove_all(s, [](int i) { return i == 4; });
+        REQUIRE(true == cmp(s.keys(), std::vector<int>{1, 3}));
+
+        const auto merged = cu::merge(s, cu::flat_set<int>{3, 0}, cu::flat_set<int>{9});
+        static_assert(std::is_same_v<const cu::flat_set<int>, decltype(merged)>);
+        REQUIRE(true == cmp(merged.keys(), std::vector<int>{0, 1, 3, 9}));
+
+        const auto from_vectors = cu::merge<cu::flat_set<int>>(std::vector<int>{5, 1}, std::vector<int>{1, 2});
+        REQUIRE(true == cmp(from_vectors.keys(), std::vector<int>{1, 2, 5}));
+        const auto concatenated = cu::merge<std::vector<int>>(s, s);
+        REQUIRE(true == cmp(concatenated, std::vector<int>{1, 3, 1, 3}));
+    }
+    {
+        auto m = cu::flat_map<int, char>{{1, 'a'}, {2, 'b'}};
+        REQUIRE(cu::contains(m, 2));
+        cu::remove_all(m, [](const auto& kv) { return kv.second == 'a'; });
+        REQUIRE(!cu::contains(m, 1));
+        const auto merged = cu::merge(m, cu::flat_map<int, char>{{2, 'x'}, {0, 'z'}});
+        REQUIRE(true == cmp(merged.keys(), std::vector<int>{0, 2}));
+        REQUIRE(true == cmp(merged.values(), std::vector<char>{'z', 'b'}));
+    }
+    {
+        // the same dispatch serves the node based containers
+        auto s = std::set<int>{1, 2, 3};
+        auto m = std::map<int, int>{{1, 1}, {2, 4}};
+        REQUIRE(cu::contains(m, 2));
+        cu::remove_all(s, 2);
+        cu::remove_all(s, [](int i) { return i == 3; });
+        REQUIRE((std::set<int>{1} == s));
+    }
+}
@@ -1,4 +1,17 @@
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "helpers.h"
 #include "pipes.h"
@@ -38,10 +51,9 @@ TEST_CASE( "test_pipe_for_each_verbose()", "[pipe]" ) {
         }
     }
     {
+        // a named stage lends its arguments, f is not moved out of x on the first call
         auto f = [incr = VerboseIntVector{1}](int& i) { i += incr[0]; };
-        auto x = mleivo::pipes::for_each(
-            f); // NB: do _not_ std::move(f) here! if move is used, f gets moved -> incr
-                // gets moved -> incr has size 0 in subsequent calls to x's operator() -> incr[0] is UB.
+        auto x = mleivo::pipes::for_each(std::move(f));
         auto v = VerboseIntVector({0, 1, 2, 3}) | x | x | x;
         for (int i = 0; i < v.size(); ++i) {
             REQUIRE(i + 3 == v[i]);
@@ -68,3 +80,439 @@ TEST_CASE( "test_pipe_accumulate()", "[pipe]" ) {
     auto ans = v | mleivo::pipes::accumulate(0, std::plus<int>{});
     REQUIRE(ans == 6);
 }
+
+TEST_CASE( "test_pipe_filter()", "[pipe]" ) {
+    {
+        auto v = std::vector<int>{0, 1, 2, 3, 4, 5};
+        auto even = v | mleivo::pipes::filter([](int i) { return i % 2 == 0; }) | mleivo::pipes::to<std::vector<int>>();
+        REQUIRE(true == cmp(std::vector<int>{0, 2, 4}, even));
+    }
+    {
+        auto v = std::vector<int>{1, 3, 5};
+        auto none = v | mleivo::pipes::filter([](int i) { return i % 2 == 0; }) | mleivo::pipes::to<std::vector<int>>();
+        REQUIRE(none.empty());
+    }
+    {
+        auto v = std::vector<int>{0, 1, 2, 3};
+        v | mleivo::pipes::filter([](int i) { return i % 2 == 1; }) | mleivo::pipes::for_each([](int& i) { i = -i; });
+        REQUIRE(true == cmp(std::vector<int>{0, -1, 2, -3}, v));
+    }
+}
+
+TEST_CASE( "test_pipe_transform()", "[pipe]" ) {
+    {
+        auto v = std::vector<int>{0, 1, 2, 3};
+        auto squares =
+            v | mleivo::pipes::transform([](int i) { return i * i; }) | mleivo::pipes::to<std::vector<int>>();
+        REQUIRE(true == cmp(std::vector<int>{0, 1, 4, 9}, squares));
+    }
+    {
+        auto halves = std::vector<int>{0, 2, 4} | mleivo::pipes::map([](int i) { return i / 2.0; })
+                      | mleivo::pipes::to<std::vector<double>>();
+        REQUIRE(true == cmp(std::vector<double>{0.0, 1.0, 2.0}, halves));
+    }
+}
+
+TEST_CASE( "test_pipe_take_while()", "[pipe]" ) {
+    auto v = std::vector<int>{0, 1, 2, 3, 0, 1};
+    auto head = v | mleivo::pipes::take_while([](int i) { return i < 3; }) | mleivo::pipes::to<std::vector<int>>();
+    REQUIRE(true == cmp(std::vector<int>{0, 1, 2}, head));
+
+    auto tail = v | mleivo::pipes::drop_while([](int i) { return i < 3; }) | mleivo::pipes::to<std::vector<int>>();
+    REQUIRE(true == cmp(std::vector<int>{3, 0, 1}, tail));
+}
+
+TEST_CASE( "test_pipe_fused_views()", "[pipe]" ) {
+    {
+        auto calls = 0;
+        auto v = std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7};
+        auto view = v | mleivo::pipes::transform([&calls](int i) { ++calls; return i * i; })
+                    | mleivo::pipes::filter([](int i) { return i % 2 == 0; });
+        REQUIRE(0 == calls);
+        auto sum = view | mleivo::pipes::accumulate(0, std::plus<int>{});
+        REQUIRE(0 + 4 + 16 + 36 == sum);
+        REQUIRE(v.size() + 4 == calls); // squared once for filter, once more for each element accumulate reads
+    }
+    {
+        auto calls = 0;
+        auto v = std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7};
+        auto found = v | mleivo::pipes::filter([&calls](int i) { ++calls; return i > 0; })
+                     | mleivo::pipes::any_of([](int i) { return i == 2; });
+        REQUIRE(found);
+        REQUIRE(3 == calls);
+    }
+    {
+        auto negated = std::vector<int>{3, 1, 2} | mleivo::pipes::transform([](int i) { return -i; });
+        auto it = negated | mleivo::pipes::max_element();
+        REQUIRE(-1 == *it);
+    }
+    {
+        auto v = std::vector<int>{0, 1, 2, 3, 4, 5};
+        auto it = v | mleivo::pipes::filter([](int i) { return i % 2 == 1; })
+                  | mleivo::pipes::find_if([](int i) { return i > 1; });
+        REQUIRE(3 == *it);
+    }
+    {
+        // iterators from a temporary view carry its callable, captures and all
+        auto v = std::vector<int>{3, 1, 2};
+        const auto offset = std::vector<int>{10};
+        const auto shifted = [offset](int i) { return i + offset[0]; };
+        REQUIRE(13 == *(v | mleivo::pipes::transform(shifted) | mleivo::pipes::max_element()));
+        REQUIRE(11 == *(v | mleivo::pipes::transform(shifted) | mleivo::pipes::min_element()));
+        auto found = v | mleivo::pipes::transform(shifted) | mleivo::pipes::find_if([](int i) { return i > 11; });
+        REQUIRE(13 == *found);
+        const auto [min, max] = v | mleivo::pipes::take_while([offset](int i) { return i < offset[0]; })
+                                | mleivo::pipes::minmax_element();
+        REQUIRE(1 == *min);
+        REQUIRE(3 == *max);
+    }
+    {
+        // every iterator has its own copy of a stateful callable, whatever the callable's size, so each pass over a
+        // view starts from the state the stage was given
+        const auto passes = [](auto f) {
+            auto view = std::vector<int>{0, 0, 0} | mleivo::pipes::transform(f);
+            auto out = std::vector<int>{};
+            for (int pass = 0; pass < 2; ++pass) {
+                for (auto i : view)
+                    out.push_back(i);
+            }
+            return out;
+        };
+        const auto expected = std::vector<int>{0, 1, 2, 0, 1, 2};
+        REQUIRE(expected == passes([n = 0](int i) mutable { return i + n++; }));
+        REQUIRE(expected == passes([n = 0, pad = std::array<char, 64>{}](int i) mutable { return i + n++ + pad[0]; }));
+    }
+}
+
+TEST_CASE( "test_pipe_execution_policy()", "[pipe]" ) {
+    {
+        auto v = std::vector<int>{3, 1, 2, 0} | mleivo::pipes::par | mleivo::pipes::sort();
+        REQUIRE(true == cmp(std::vector<int>{0, 1, 2, 3}, v));
+    }
+    {
+        auto v = std::vector<int>{3, 1, 2, 0};
+        v | mleivo::pipes::sort(mleivo::pipes::par_unseq, std::greater<int>{});
+        REQUIRE(true == cmp(std::vector<int>{3, 2, 1, 0}, v));
+    }
+    {
+        auto v = std::vector<int>{0, 1, 2, 3};
+        v | mleivo::pipes::par | mleivo::pipes::for_each([](int& i) { i *= i; });
+        REQUIRE(true == cmp(std::vector<int>{0, 1, 4, 9}, v));
+    }
+    {
+        auto v = std::vector<int>{0, 1, 2, 3};
+        REQUIRE(6 == (v | mleivo::pipes::par | mleivo::pipes::accumulate(0, std::plus<int>{})));
+        REQUIRE(6 == (v | mleivo::pipes::accumulate(std::execution::par, 0, std::plus<int>{})));
+        REQUIRE(3 == *(v | mleivo::pipes::par_unseq | mleivo::pipes::max_element()));
+    }
+    {
+        const auto v = std::vector<int>{0, 1, 2, 3, 4, 5};
+        auto odd = v | mleivo::pipes::par | mleivo::pipes::filter([](int i) { return i % 2 == 1; })
+                   | mleivo::pipes::to<std::vector<int>>();
+        REQUIRE(true == cmp(std::vector<int>{1, 3, 5}, odd));
+        REQUIRE(3 == (v | mleivo::pipes::par | mleivo::pipes::transform([](int i) { return i * i; })
+                      | mleivo::pipes::count_if([](int i) { return i > 4; })));
+    }
+}
+
+TEST_CASE( "test_pipe_algorithms()", "[pipe]" ) {
+    {
+        auto v = std::vector<int>{1, 2, 3, 4} | mleivo::pipes::inclusive_scan();
+        REQUIRE(true == cmp(std::vector<int>{1, 3, 6, 10}, v));
+    }
+    {
+        auto v = std::vector<int>{1, 2, 3, 4} | mleivo::pipes::par | mleivo::pipes::inclusive_scan(std::plus<int>{}, 1);
+        REQUIRE(true == cmp(std::vector<int>{2, 4, 7, 11}, v));
+    }
+    {
+        auto v = std::vector<int>{5, 3, 1, 4, 2, 0} | mleivo::pipes::nth_element(2);
+        REQUIRE(2 == v[2]);
+        v | mleivo::pipes::partial_sort(mleivo::pipes::par, 3);
+        REQUIRE(true == cmp(std::vector<int>{0, 1, 2}, std::vector<int>(v.begin(), v.begin() + 3)));
+    }
+    {
+        auto v = std::vector<int>{0, 1, 2, 3, 4, 5}
+                 | mleivo::pipes::stable_partition(mleivo::pipes::par, [](int i) { return i % 2 == 0; });
+        REQUIRE(true == cmp(std::vector<int>{0, 2, 4, 1, 3, 5}, v));
+    }
+    {
+        auto v = std::vector<int>{0, 1, 2, 3};
+        auto sum_of_squares = v | mleivo::pipes::par
+                              | mleivo::pipes::transform_reduce(0, std::plus<int>{}, [](int i) { return i * i; });
+        REQUIRE(14 == sum_of_squares);
+        REQUIRE(2 == (v | mleivo::pipes::count_if([](int i) { return i % 2 == 0; })));
+        REQUIRE(true == (v | mleivo::pipes::is_sorted()));
+    }
+}
+
+namespace {
+template <typename T, typename KeyF>
+bool radix_sorts_like_stable_sort(std::vector<T> v, KeyF key) {
+    auto expected = v;
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&key](const T& a, const T& b) { return std::invoke(key, a) < std::invoke(key, b); });
+    v | mleivo::pipes::radix_sort(key);
+    return expected == v;
+}
+} // namespace
+
+TEST_CASE( "test_pipe_radix_sort()", "[pipe]" ) {
+    namespace pipes = mleivo::pipes;
+    auto rng = std::mt19937_64(11);
+    {
+        auto v = std::vector<int>{3, -1, 2, 0, -7, 2147483647, -2147483647 - 1} | pipes::radix_sort();
+        REQUIRE(true == cmp(std::vector<int>{-2147483647 - 1, -7, -1, 0, 2, 3, 2147483647}, v));
+    }
+    {
+        auto v = std::vector<double>{2.5, -0.5, 0.0, -1e300, 1e-300, -3.25, 7.0} | pipes::radix_sort();
+        REQUIRE(true == cmp(std::vector<double>{-1e300, -3.25, -0.5, 0.0, 1e-300, 2.5, 7.0}, v));
+        auto f = std::vector<float>{1.5f, -2.0f, 0.25f, -0.125f} | pipes::radix_sort<11>();
+        REQUIRE(true == cmp(std::vector<float>{-2.0f, -0.125f, 0.25f, 1.5f}, f));
+    }
+    {
+        // records by 64-bit id, equal ids keep their order
+        struct record {
+            std::uint64_t id;
+            int seq;
+            bool operator==(const record& o) const {
+                return id == o.id && seq == o.seq;
+            }
+        };
+        auto records = std::vector<record>(5000);
+        for (std::size_t i = 0; i < records.size(); ++i)
+            records[i] = {rng() % 1000 * 0x0101010101ull, static_cast<int>(i)};
+        const auto id = [](const record& r) { return r.id; };
+        REQUIRE(radix_sorts_like_stable_sort(records, id));
+        auto copy = records;
+        copy | pipes::radix_sort<16>(id);
+        auto expected = records;
+        std::stable_sort(expected.begin(), expected.end(), [](auto& a, auto& b) { return a.id < b.id; });
+        REQUIRE(expected == copy);
+        copy = records;
+        copy | pipes::radix_sort<11>(pipes::par, id);
+        REQUIRE(expected == copy);
+        REQUIRE(radix_sorts_like_stable_sort(records, &record::id));
+    }
+    {
+        // fixed-width strings compare like std::string, bytes above 127 after the ascii ones
+        using name = std::array<char, 3>;
+        auto names = std::vector<std::pair<name, int>>{{{'b', 'a', 'c'}, 0},
+                                                       {{'a', 'z', 'z'}, 1},
+                                                       {{'\xe4', 'a', 'a'}, 2},
+                                                       {{'b', 'a', 'c'}, 3},
+                                                       {{'a', 'a', 'b'}, 4}};
+        names | pipes::radix_sort([](const auto& p) { return p.first; });
+        auto order = std::vector<int>{};
+        for (const auto& p : names)
+            order.push_back(p.second);
+        REQUIRE(true == cmp(std::vector<int>{4, 1, 0, 3, 2}, order));
+    }
+    {
+        // enough elements for a parallel sort to split them in chunks, and keys sharing most of their digits
+        auto v = std::vector<std::int64_t>(300'000);
+        for (auto& i : v)
+            i = static_cast<std::int64_t>(rng() % 100'000) - 50'000;
+        auto expected = v;
+        std::sort(expected.begin(), expected.end());
+        auto par = v;
+        par | pipes::par | pipes::radix_sort();
+        REQUIRE(expected == par);
+        v | pipes::radix_sort<16>();
+        REQUIRE(expected == v);
+
+        auto pairs = std::vector<std::pair<std::uint32_t, std::size_t>>(300'000);
+        for (std::size_t i = 0; i < pairs.size(); ++i)
+            pairs[i] = {static_cast<std::uint32_t>(rng() % 5000), i};
+        auto expected_pairs = pairs;
+        std::sort(expected_pairs.begin(), expected_pairs.end());
+        pairs | pipes::par_unseq | pipes::radix_sort([](const auto& p) { return p.first; });
+        REQUIRE(expected_pairs == pairs);
+    }
+    {
+        enum class level : std::int8_t { low = -1, mid = 0, high = 1 };
+        auto v = std::vector<level>{level::high, level::low, level::mid} | pipes::radix_sort();
+        REQUIRE(true == cmp(std::vector<level>{level::low, level::mid, level::high}, v));
+        REQUIRE(true == (std::vector<int>{} | pipes::radix_sort()).empty());
+    }
+}
+
+TEST_CASE( "test_pipe_morsels()", "[pipe]" ) {
+    namespace pipes = mleivo::pipes;
+    const auto add_one = [](int& i) { ++i; };
+    const auto twice = [](int& i) { i *= 2; };
+    {
+        // every element goes through the stages in order, over many morsels and a ragged last one
+        auto v = std::vector<int>(1'000'003);
+        std::iota(v.begin(), v.end(), 0);
+        auto visits = std::atomic<std::size_t>{0};
+        v | pipes::morsels | pipes::for_each(add_one) | pipes::for_each(twice)
+            | pipes::for_each([&](int&) { visits.fetch_add(1, std::memory_order_relaxed); }) | pipes::run();
+        REQUIRE(v.size() == visits.load());
+        auto expected = std::vector<int>(v.size());
+        for (std::size_t i = 0; i < expected.size(); ++i)
+            expected[i] = (static_cast<int>(i) + 1) * 2;
+        REQUIRE(expected == v);
+    }
+    {
+        // the queued stages run before a pipeline breaker, whether it returns the container or a value
+        auto v = std::vector<int>{5, 1, 4, 2, 3} | pipes::morsels | pipes::for_each(add_one) | pipes::replace(6, 0)
+                 | pipes::sort();
+        REQUIRE(true == cmp(std::vector<int>{0, 2, 3, 4, 5}, v));
+        REQUIRE(20 == (v | pipes::morsels | pipes::fill(2) | pipes::for_each(twice) | pipes::accumulate(0)));
+        REQUIRE(5 == (v | pipes::morsels | pipes::replace_if([](int i) { return i == 4; }, 1) | pipes::count(1)));
+        auto odd = std::vector<int>{1, 2, 3, 4} | pipes::morsels | pipes::for_each(add_one)
+                   | pipes::filter([](int i) { return i % 2 == 1; }) | pipes::to<std::vector<int>>();
+        REQUIRE(true == cmp(std::vector<int>{3, 5}, odd));
+        auto sorted = std::vector<int>{3, 1, 2} | pipes::morsels | pipes::for_each(twice) | pipes::par | pipes::sort();
+        REQUIRE(true == cmp(std::vector<int>{2, 4, 6}, sorted));
+    }
+    {
+        // no random access, no morsels: the stages run one after another
+        auto l = std::list<int>{1, 2, 3};
+        l | pipes::morsels | pipes::for_each(add_one) | pipes::for_each(twice) | pipes::run();
+        REQUIRE(true == (std::list<int>{4, 6, 8} == l));
+    }
+    {
+        // run() returns the container, an rvalue one by value
+        auto v = std::vector<int>{1, 2, 3};
+        auto& same = v | pipes::morsels | pipes::for_each(twice) | pipes::run();
+        REQUIRE(&same == &v);
+        REQUIRE(true == cmp(std::vector<int>{2, 4, 6}, v));
+        auto&& w = std::vector<int>{1, 2} | pipes::morsels | pipes::for_each(add_one) | pipes::run();
+        static_assert(std::is_same_v<std::vector<int>&&, decltype(w)>);
+        REQUIRE(true == cmp(std::vector<int>{2, 3}, w));
+        REQUIRE(true == cmp(std::vector<int>{4, 8, 12}, v | pipes::for_each(twice) | pipes::run()));
+    }
+    {
+        // a pipe that is not run runs nothing, not even when the bound is destroyed
+        auto v = std::vector<int>{1, 2, 3};
+        {
+            [[maybe_unused]] auto pipe = v | pipes::morsels | pipes::for_each(twice);
+        }
+        REQUIRE(true == cmp(std::vector<int>{1, 2, 3}, v));
+    }
+}
+
+TEST_CASE( "test_pipe_pipeline()", "[pipe]" ) {
+    namespace pipes = mleivo::pipes;
+    {
+        // a pipeline owns its stages' arguments, the temporaries they were made from are gone when it runs
+        const auto p = pipes::for_each([offset = std::vector<int>{1}](int& i) { i += offset[0]; }) | pipes::sort()
+                       | pipes::accumulate(0);
+        auto v = std::vector<int>{3, 1, 2};
+        REQUIRE(9 == (v | p));
+        REQUIRE(true == cmp(std::vector<int>{2, 3, 4}, v));
+        REQUIRE(12 == (v | p));
+        REQUIRE(3 == (std::vector<int>{0, 1} | p));
+    }
+    {
+        // so does a single named stage
+        const auto concat = [](std::string acc, const std::string& w) { return acc + w; };
+        const auto s = pipes::accumulate(std::string("->"), concat);
+        const auto p = pipes::replace(std::string("a"), std::string("b"));
+        auto w = std::vector<std::string>{"a", "c"};
+        REQUIRE("->ac" == (w | s));
+        REQUIRE("->ac" == (w | s));
+        w | p;
+        REQUIRE("->bc" == (w | s));
+        REQUIRE("->bc" == (std::vector<std::string>{"a", "c"} | p | s));
+    }
+    {
+        // pipelines compose with stages and other pipelines, and return the container when they end in one
+        const auto twice = [](int& i) { i *= 2; };
+        const auto head = pipes::par | pipes::for_each(twice);
+        const auto p = head | pipes::sort() | (pipes::morsels | pipes::for_each(twice) | pipes::replace(8, 0));
+        auto v = std::vector<int>{2, 1, 3};
+        auto& same = v | p;
+        REQUIRE(&same == &v);
+        REQUIRE(true == cmp(std::vector<int>{4, 0, 12}, v));
+        // an rvalue container comes out by value, also from inside the bound of par or morsels
+        auto w = std::vector<int>{1, 2} | p;
+        REQUIRE(true == cmp(std::vector<int>{4, 0}, w));
+        auto sorted = std::vector<int>{3, 2, 1} | (pipes::morsels | pipes::for_each(twice) | pipes::sort());
+        REQUIRE(true == cmp(std::vector<int>{2, 4, 6}, sorted));
+        const auto odd_of = pipes::filter([](int i) { return i % 2 == 1; }) | pipes::to<std::vector<int>>();
+        auto odd = std::vector<int>{1, 2, 3} | odd_of;
+        REQUIRE(true == cmp(std::vector<int>{1, 3}, odd));
+    }
+    {
+        // one pipeline, many batches on many threads
+        const auto p = pipes::for_each([](int& i) { i = i * i; }) | pipes::accumulate(std::int64_t{0});
+        auto sums = std::vector<std::int64_t>(4);
+        auto threads = std::vector<std::thread>{};
+        for (std::size_t t = 0; t < sums.size(); ++t) {
+            threads.emplace_back([&, t] {
+                for (int batch = 0; batch < 1000; ++batch)
+                    sums[t] += std::vector<int>{1, 2, 3, static_cast<int>(t)} | p;
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        for (std::size_t t = 0; t < sums.size(); ++t)
+            REQUIRE(1000 * (14 + static_cast<std::int64_t>(t * t)) == sums[t]);
+    }
+}
+
+TEST_CASE( "test_pipe_sum()", "[pipe]" ) {
+    namespace pipes = mleivo::pipes;
+    {
+        auto v = std::vector<int>(1001);
+        std::iota(v.begin(), v.end(), 0);
+        REQUIRE(500500 == (v | pipes::sum()));
+        REQUIRE(500500 == (v | pipes::par | pipes::sum(pipes::summation::neumaier)));
+        REQUIRE(6 == (std::list<int>{1, 2, 3} | pipes::sum()));
+        REQUIRE(0.0 == (std::vector<double>{} | pipes::sum(pipes::summation::pairwise)));
+        REQUIRE(4 == (std::vector<int>{1, 2, 3, 4} | pipes::filter([](int i) { return i % 2 == 1; }) | pipes::sum()));
+    }
+    {
+        // narrow integers are summed as int, the way std::accumulate(first, last, 0) promotes them
+        const auto bytes = std::vector<std::uint8_t>(100'000, 200);
+        const auto expected = std::accumulate(bytes.begin(), bytes.end(), 0);
+        static_assert(std::is_same_v<int, decltype(bytes | pipes::sum())>);
+        REQUIRE(expected == (bytes | pipes::sum()));
+        REQUIRE(expected == (bytes | pipes::par | pipes::sum()));
+        REQUIRE(-300 == (std::list<std::int8_t>{-100, -100, -100} | pipes::sum()));
+        REQUIRE(70'000 == (std::vector<std::int16_t>{30'000, 30'000, 10'000} | pipes::sum()));
+    }
+    {
+        // other types are added left to right, whatever the mode or policy
+        auto words = std::vector<std::string>(100, "ab");
+        words.front() = "x";
+        words.back() = "y";
+        const auto expected = std::accumulate(words.begin(), words.end(), std::string{});
+        REQUIRE(expected == (words | pipes::sum()));
+        REQUIRE(expected == (words | pipes::par | pipes::sum(pipes::summation::pairwise)));
+        REQUIRE("abc" == (std::list<std::string>{"a", "b", "c"} | pipes::sum(pipes::summation::neumaier)));
+    }
+    {
+        // what a single accumulator loses, the compensated sum keeps
+        const auto v = std::vector<double>{1e100, 1.0, -1e100, 1e-3};
+        REQUIRE(1.001 == (v | pipes::sum(pipes::summation::neumaier)));
+        REQUIRE(1.001 == (std::list<double>(v.begin(), v.end()) | pipes::sum(pipes::summation::neumaier)));
+        const auto tenths = std::vector<float>(1'000'000, 0.1f);
+        const auto exact = static_cast<float>(1e6 * static_cast<double>(0.1f));
+        REQUIRE(exact == (tenths | pipes::sum(pipes::summation::neumaier)));
+        REQUIRE(exact == (tenths | pipes::par | pipes::sum(pipes::summation::neumaier)));
+        REQUIRE(std::abs(exact - (tenths | pipes::sum(pipes::summation::pairwise))) < 0.1f);
+        REQUIRE(std::abs(exact - std::accumulate(tenths.begin(), tenths.end(), 0.0f)) > 1.0f);
+    }
+    {
+        // the parallel tree depends on the input alone: the same bits for any number of threads, and pairwise gives
+        // the same bits without one
+        auto rng = std::mt19937_64(5);
+        auto dist = std::uniform_real_distribution<double>(-1e6, 1e6);
+        auto v = std::vector<double>(1'000'003);
+        for (auto& d : v)
+            d = dist(rng);
+        using sum = mleivo::pipes::detail::sum;
+        auto one = mleivo::exec::thread_pool(1);
+        auto four = mleivo::exec::thread_pool(4);
+        for (const auto mode : {pipes::summation::fast, pipes::summation::pairwise, pipes::summation::neumaier}) {
+            const auto expected = sum::parallel(one, v.begin(), v.end(), mode);
+            REQUIRE(expected == sum::parallel(four, v.begin(), v.end(), mode));
+            REQUIRE(expected == (v | pipes::par | pipes::sum(mode)));
+        }
+        REQUIRE(sum::parallel(four, v.begin(), v.end(), pipes::summation::pairwise)
+                == (v | pipes::sum(pipes::summation::pairwise)));
+    }
+}
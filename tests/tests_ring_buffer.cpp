@@ -0,0 +1,186 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "containerutils.h"
+#include "helpers.h"
+#include "ring_buffer.h"
+
+TEST_CASE("test_ring_buffer()", "[ring buffer]") {
+    {
+        auto r = mleivo::cu::ring_buffer<int>{};
+        REQUIRE(r.empty());
+        for (int i = 0; i < 100; ++i)
+            r.push_back(i);
+        REQUIRE(100 == r.size());
+        REQUIRE(128 == r.capacity());
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(i == r.front());
+            r.pop_front();
+        }
+        REQUIRE(r.empty());
+    }
+    {
+        // wrapping around the seam, and growing while wrapped keeps the order
+        auto r = mleivo::cu::ring_buffer<std::string>(4);
+        r.push_back("a");
+        r.push_back("b");
+        r.push_back("c");
+        r.pop_front();
+        r.pop_front();
+        r.push_back("d");
+        r.push_back("e");
+        r.push_front("z");
+        REQUIRE(r.full());
+        REQUIRE(true == cmp(r, std::vector<std::string>{"z", "c", "d", "e"}));
+        r.push_back("f");
+        REQUIRE(8 == r.capacity());
+        REQUIRE(true == cmp(r, std::vector<std::string>{"z", "c", "d", "e", "f"}));
+        r.pop_back();
+        REQUIRE("e" == r.back());
+    }
+    {
+        auto r = mleivo::cu::ring_buffer<int, false>(8);
+        for (int i = 0; i < 6; ++i)
+            r.push_back(i);
+        r.pop_front(5);
+        for (int i = 6; i < 13; ++i)
+            r.push_back(i);
+        REQUIRE(r.full());
+        REQUIRE(8 == r.capacity());
+
+        // the elements in order are the two segments one after the other
+        auto first = r.first_segment();
+        auto second = r.second_segment();
+        REQUIRE(3 == first.size());
+        REQUIRE(5 == second.size());
+        auto out = std::vector<int>(first.begin(), first.end());
+        out.insert(out.end(), second.begin(), second.end());
+        REQUIRE(out == std::vector<int>{5, 6, 7, 8, 9, 10, 11, 12});
+    }
+    {
+        // pushing one of its own elements into a full buffer copies it before the storage is released
+        auto r = mleivo::cu::ring_buffer<std::string>(2);
+        r.push_back(std::string(32, 'a'));
+        r.push_back(std::string(32, 'b'));
+        REQUIRE(r.full());
+        r.push_back(r.front());
+        REQUIRE(true == cmp(r, std::vector<std::string>{std::string(32, 'a'), std::string(32, 'b'),
+                                                        std::string(32, 'a')}));
+        while (!r.full())
+            r.push_back("c");
+        r.push_front(r.back());
+        REQUIRE(16 == r.capacity());
+        REQUIRE("c" == r.front());
+        REQUIRE(std::string(32, 'a') == r[1]);
+        REQUIRE("c" == r.back());
+    }
+    {
+        auto r = mleivo::cu::ring_buffer<move_only_type>{};
+        for (int i = 0; i < 10; ++i)
+            r.emplace_back(i);
+        auto moved = std::move(r);
+        REQUIRE(r.empty());
+        REQUIRE(10 == moved.size());
+        REQUIRE(9 == *moved.back().m_val);
+    }
+}
+
+TEST_CASE("test_ring_buffer_container_utils()", "[ring buffer]") {
+    auto make = [] {
+        auto r = mleivo::cu::ring_buffer<int>(8);
+        for (int i = 0; i < 4; ++i) {
+            r.push_back(0);
+            r.pop_front();
+        }
+        for (auto i : {3, 1, 2, 3, 1, 4})
+            r.push_back(i);
+        return r;
+    };
+    {
+        auto r = make();
+        mleivo::cu::pop_front(r);
+        REQUIRE(true == cmp(r, std::vector<int>{1, 2, 3, 1, 4}));
+        mleivo::cu::remove_all(r, 1);
+        REQUIRE(true == cmp(r, std::vector<int>{2, 3, 4}));
+    }
+    {
+        auto r = make();
+        mleivo::cu::remove_duplicates(r);
+        REQUIRE(true == cmp(r, std::vector<int>{3, 1, 2, 4}));
+        REQUIRE(true == mleivo::cu::contains(r, 4));
+        REQUIRE(2 == mleivo::cu::index_of(r, 2));
+        mleivo::cu::move_to_index(r, 3, 0);
+        REQUIRE(true == cmp(r, std::vector<int>{4, 3, 1, 2}));
+    }
+    {
+        const auto r = make();
+        auto doubled = mleivo::cu::transform(r, [](int i) { return i * 2; });
+        static_assert(std::is_same_v<decltype(doubled), mleivo::cu::ring_buffer<int>>);
+        REQUIRE(true == cmp(doubled, std::vector<int>{6, 2, 4, 6, 2, 8}));
+        REQUIRE(std::vector<int>{3, 1, 2, 3, 1, 4} == mleivo::cu::to_std_vector(r));
+        REQUIRE(std::vector<double>{3, 1, 2, 3, 1, 4} == mleivo::cu::static_cast_all<double>(r));
+        auto sum = 0;
+        for (auto&& [i, e] : mleivo::cu::enumerate(r))
+            sum += static_cast<int>(i) * e;
+        REQUIRE(0 * 3 + 1 * 1 + 2 * 2 + 3 * 3 + 4 * 1 + 5 * 4 == sum);
+    }
+}
+
+TEST_CASE("test_fixed_ring_buffer_container_utils()", "[ring buffer]") {
+    // a fixed ring_buffer has no reserve, so the utilities that reserve for their output append to it as they are
+    using fixed_t = mleivo::cu::ring_buffer<int, false>;
+    static_assert(!mleivo::type_traits::has_method_reserve_v<fixed_t>);
+    auto out = fixed_t(8);
+    mleivo::cu::filter_into(out, std::vector<int>{1, 2, 3, 4, 5, 6}, [](int i) { return i % 2 == 0; });
+    mleivo::cu::transform_into(out, std::vector<int>{1, 2}, [](int i) { return i * 10; });
+    mleivo::cu::static_cast_all_into(out, std::vector<double>{7.0});
+    REQUIRE(true == cmp(out, std::vector<int>{2, 4, 6, 10, 20, 7}));
+    REQUIRE(8 == out.capacity());
+}
+
+TEST_CASE("test_spsc_ring_buffer()", "[ring buffer]") {
+    {
+        auto q = mleivo::cu::spsc_ring_buffer<std::string>(3);
+        REQUIRE(4 == q.capacity());
+        for (int i = 0; i < 4; ++i)
+            REQUIRE(q.try_push(std::to_string(i)));
+        REQUIRE(!q.try_push("full"));
+        auto s = std::string{};
+        REQUIRE(q.try_pop(s));
+        REQUIRE("0" == s);
+        REQUIRE(q.try_push("4"));
+        auto out = std::vector<std::string>(8);
+        REQUIRE(4 == q.try_pop_n(out.begin(), out.size()));
+        REQUIRE(std::vector<std::string>{"1", "2", "3", "4"} == std::vector<std::string>(out.begin(), out.begin() + 4));
+        REQUIRE(!q.try_pop(s));
+        q.try_push("left behind, destroyed with the queue");
+    }
+    {
+        // values pass between the threads in order, in batches that wrap around the seam
+        constexpr auto count = std::uint64_t{1'000'000};
+        auto q = mleivo::cu::spsc_ring_buffer<std::uint64_t>(1024);
+        auto producer = std::thread([&q] {
+            auto batch = std::vector<std::uint64_t>(100);
+            for (auto next = std::uint64_t{0}; next < count;) {
+                std::iota(batch.begin(), batch.end(), next);
+                const auto n = std::min<std::uint64_t>(batch.size(), count - next);
+                next += q.try_push_n(batch.begin(), static_cast<std::size_t>(n));
+            }
+        });
+        auto expected = std::uint64_t{0};
+        auto in_order = true;
+        auto batch = std::vector<std::uint64_t>(77);
+        while (expected < count) {
+            const auto n = q.try_pop_n(batch.begin(), batch.size());
+            for (std::size_t i = 0; i < n; ++i)
+                in_order = in_order && batch[i] == expected++;
+        }
+        producer.join();
+        REQUIRE(in_order);
+        REQUIRE(0 == q.size_approx());
+    }
+}
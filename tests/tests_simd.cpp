@@ -0,0 +1,176 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "containerutils.h"
+#include "simd.h"
+
+namespace {
+enum class color : std::uint16_t {
+    red,
+    green,
+    blue,
+};
+
+// every kernel the cpu can run, scalar included
+std::vector<mleivo::simd::isa> isas() {
+    auto out = std::vector<mleivo::simd::isa>{mleivo::simd::isa::scalar};
+    for (auto level : {mleivo::simd::isa::sse2, mleivo::simd::isa::avx2, mleivo::simd::isa::avx512}) {
+        if (level <= mleivo::simd::best_isa())
+            out.push_back(level);
+    }
+    return out;
+}
+
+template <typename T>
+void require_finds_every_position(mleivo::simd::isa level) {
+    // sizes around every vector width, with the match in the vector body and in the scalar tail
+    for (std::size_t n = 0; n < 150; ++n) {
+        auto v = std::vector<T>(n, static_cast<T>(1));
+        REQUIRE(v.data() + n == mleivo::simd::find(v.data(), v.data() + n, static_cast<T>(2), level));
+        for (std::size_t i = 0; i < n; ++i) {
+            v[i] = static_cast<T>(2);
+            REQUIRE(v.data() + i == mleivo::simd::find(v.data(), v.data() + n, static_cast<T>(2), level));
+            v[i] = static_cast<T>(1);
+        }
+    }
+}
+
+// every kernel agrees with the scalar loop for all lengths around the vector widths
+template <bool Saturate, typename From, typename To>
+void require_converts_like_scalar(const std::vector<From>& values) {
+    for (auto level : isas()) {
+        for (std::size_t n = 0; n <= values.size(); ++n) {
+            auto expected = std::vector<To>(n);
+            auto actual = std::vector<To>(n);
+            mleivo::simd::convert<Saturate>(values.data(), expected.data(), n, mleivo::simd::isa::scalar);
+            mleivo::simd::convert<Saturate>(values.data(), actual.data(), n, level);
+            for (std::size_t i = 0; i < n; ++i) {
+                if (std::isnan(static_cast<double>(expected[i])))
+                    REQUIRE(std::isnan(static_cast<double>(actual[i])));
+                else
+                    REQUIRE(expected[i] == actual[i]);
+            }
+        }
+    }
+}
+
+template <typename T>
+std::vector<T> ramp(std::size_t n, T step, T offset = T{}) {
+    auto out = std::vector<T>(n);
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = static_cast<T>(offset + static_cast<T>(i) * step);
+    return out;
+}
+} // namespace
+
+TEST_CASE("test_simd_find()", "[simd]") {
+    for (auto level : isas()) {
+        require_finds_every_position<std::int8_t>(level);
+        require_finds_every_position<std::uint16_t>(level);
+        require_finds_every_position<std::int32_t>(level);
+        require_finds_every_position<std::uint64_t>(level);
+        require_finds_every_position<float>(level);
+        require_finds_every_position<double>(level);
+    }
+}
+
+TEST_CASE("test_simd_find_special_values()", "[simd]") {
+    for (auto level : isas()) {
+        {
+            auto v = std::vector<double>(40, 1.0);
+            v[3] = std::nan("");
+            v[20] = -0.0;
+            REQUIRE(v.data() + 40 == mleivo::simd::find(v.data(), v.data() + 40, std::nan(""), level));
+            REQUIRE(v.data() + 20 == mleivo::simd::find(v.data(), v.data() + 40, 0.0, level));
+        }
+        {
+            auto v = std::vector<std::int64_t>(40, 0);
+            v[17] = std::int64_t{1} << 32; // equal low half, different high half
+            v[33] = 1;
+            REQUIRE(v.data() + 33 == mleivo::simd::find(v.data(), v.data() + 40, std::int64_t{1}, level));
+        }
+    }
+}
+
+TEST_CASE("test_simd_contains()", "[simd]") {
+    {
+        auto v = std::vector<color>(100, color::red);
+        v[70] = color::blue;
+        REQUIRE(true == mleivo::cu::contains(v, color::blue));
+        REQUIRE(false == mleivo::cu::contains(v, color::green));
+        REQUIRE(70 == mleivo::cu::index_of(v, color::blue));
+    }
+    {
+        int values[64] = {};
+        auto v = std::vector<const int*>{};
+        for (auto& value : values)
+            v.push_back(&value);
+        REQUIRE(true == mleivo::cu::contains(v, static_cast<const int*>(&values[63])));
+        REQUIRE(63 == mleivo::cu::index_of(v, static_cast<const int*>(&values[63])));
+        REQUIRE(false == mleivo::cu::contains(v, static_cast<const int*>(nullptr)));
+    }
+    {
+        int values[] = {3, 4, 5};
+        REQUIRE(true == mleivo::cu::contains(values, 4));
+    }
+}
+
+TEST_CASE("test_simd_convert()", "[simd]") {
+    require_converts_like_scalar<false, std::int32_t, float>(ramp<std::int32_t>(150, 7919, -500000));
+    require_converts_like_scalar<false, float, std::int32_t>(ramp<float>(150, 13.75f, -1000.5f));
+    require_converts_like_scalar<false, double, float>(ramp<double>(150, 1.0 / 3, -25));
+    require_converts_like_scalar<false, std::int64_t, std::int32_t>(ramp<std::int64_t>(150, 12345, -900000));
+    require_converts_like_scalar<false, std::uint8_t, std::int32_t>(ramp<std::uint8_t>(150, 3));
+    require_converts_like_scalar<false, std::uint8_t, float>(ramp<std::uint8_t>(150, 3));
+    require_converts_like_scalar<false, std::int16_t, double>(ramp<std::int16_t>(150, -211));
+
+    // rounding toward zero as static_cast does
+    auto out = std::vector<std::int32_t>(2);
+    auto in = std::vector<float>{-1.75f, 1.75f};
+    mleivo::simd::convert(in.data(), out.data(), in.size());
+    REQUIRE(-1 == out[0]);
+    REQUIRE(1 == out[1]);
+}
+
+TEST_CASE("test_simd_convert_saturating()", "[simd]") {
+    constexpr auto nan = std::numeric_limits<float>::quiet_NaN();
+    constexpr auto inf = std::numeric_limits<float>::infinity();
+    constexpr auto int_max = std::numeric_limits<std::int32_t>::max();
+    constexpr auto int_min = std::numeric_limits<std::int32_t>::min();
+
+    auto floats = std::vector<float>{nan, inf, -inf, 2147483648.f, -2147483648.f, 3e9f, -3e9f, 1.5f, -1.5f};
+    auto ints = std::vector<std::int32_t>{0, int_max, int_min, int_max, int_min, int_max, int_min, 1, -1};
+    floats.insert(floats.end(), floats.begin(), floats.end()); // spill into a second vector and the tail
+    ints.insert(ints.end(), ints.begin(), ints.end());
+    for (auto level : isas()) {
+        auto out = std::vector<std::int32_t>(floats.size());
+        mleivo::simd::convert<true>(floats.data(), out.data(), floats.size(), level);
+        REQUIRE(ints == out);
+    }
+
+    constexpr auto i64_max = std::numeric_limits<std::int64_t>::max();
+    constexpr auto i64_min = std::numeric_limits<std::int64_t>::min();
+    auto wide = std::vector<std::int64_t>{i64_max, i64_min, 1LL << 31, -(1LL << 31) - 1, 42, -42, 0, 7, int_max};
+    auto narrow = std::vector<std::int32_t>{int_max, int_min, int_max, int_min, 42, -42, 0, 7, int_max};
+    wide.insert(wide.end(), wide.begin(), wide.end());
+    narrow.insert(narrow.end(), narrow.begin(), narrow.end());
+    for (auto level : isas()) {
+        auto out = std::vector<std::int32_t>(wide.size());
+        mleivo::simd::convert<true>(wide.data(), out.data(), wide.size(), level);
+        REQUIRE(narrow == out);
+    }
+
+    constexpr auto float_max = std::numeric_limits<float>::max();
+    auto doubles = std::vector<double>{1e300, -1e300, 1.0, std::numeric_limits<double>::infinity(), 0.5, -2.0, 3.0,
+                                       4.0, 5.0, 1e39, -1e39};
+    auto clamped = std::vector<float>{float_max, -float_max, 1.0f, float_max, 0.5f, -2.0f, 3.0f, 4.0f, 5.0f, float_max,
+                                      -float_max};
+    for (auto level : isas()) {
+        auto out = std::vector<float>(doubles.size());
+        mleivo::simd::convert<true>(doubles.data(), out.data(), doubles.size(), level);
+        REQUIRE(clamped == out);
+    }
+}
@@ -0,0 +1,151 @@
+#include <catch2/catch_test_macros.hpp>
+#include <list>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "containerutils.h"
+#include "helpers.h"
+#include "small_vector.h"
+
+namespace {
+template <typename ContainerT>
+bool stored_inside(const ContainerT& c) {
+    const auto* p = reinterpret_cast<const unsigned char*>(c.data());
+    const auto* object = reinterpret_cast<const unsigned char*>(&c);
+    return p >= object && p < object + sizeof(c);
+}
+} // namespace
+
+TEST_CASE("test_small_vector()", "[small vector]") {
+    using mleivo::cu::small_vector;
+    static_assert(mleivo::type_traits::has_method_push_back_v<small_vector<int, 4>>);
+    static_assert(mleivo::type_traits::has_method_reserve_v<small_vector<int, 4>>);
+    static_assert(std::is_same_v<int, mleivo::type_traits::value_type<small_vector<int, 4>>>);
+    {
+        auto v = small_vector<std::string, 4>{};
+        REQUIRE(v.empty());
+        REQUIRE(4 == v.capacity());
+        for (int i = 0; i < 4; ++i)
+            v.push_back(std::to_string(i));
+        REQUIRE(v.is_inline());
+        REQUIRE(stored_inside(v));
+        v.emplace_back(20, 'x'); // longer than any small string buffer
+        REQUIRE(!v.is_inline());
+        REQUIRE(8 == v.capacity());
+        REQUIRE(true == cmp(v, std::vector<std::string>{"0", "1", "2", "3", std::string(20, 'x')}));
+
+        const auto* heap = v.data();
+        auto moved = std::move(v);
+        REQUIRE(heap == moved.data()); // the allocation is stolen
+        REQUIRE(v.empty());
+        REQUIRE(v.is_inline());
+
+        auto copy = moved;
+        REQUIRE(copy == moved);
+        copy.pop_back();
+        REQUIRE(copy != moved);
+        REQUIRE(copy < moved);
+    }
+    {
+        auto v = small_vector<move_only_type, 2>{};
+        v.emplace_back(1);
+        v.emplace_back(3);
+        auto moved = std::move(v);
+        REQUIRE(stored_inside(moved));
+        REQUIRE(v.empty());
+        moved.emplace(moved.begin() + 1, 2);
+        moved.insert(moved.begin(), move_only_type(0));
+        REQUIRE(4 == moved.size());
+        for (int i = 0; i < 4; ++i)
+            REQUIRE(i == *moved[i].m_val);
+        moved.erase(moved.begin(), moved.begin() + 3);
+        REQUIRE(1 == moved.size());
+        REQUIRE(3 == *moved.front().m_val);
+    }
+    {
+        auto v = small_vector<int, 8>{1, 2, 3};
+        const auto extra = std::list<int>{7, 8, 9, 10, 11, 12};
+        v.insert(v.begin() + 1, extra.begin(), extra.end());
+        REQUIRE(true == cmp(v, std::vector<int>{1, 7, 8, 9, 10, 11, 12, 2, 3}));
+        v.resize(2);
+        v.resize(4, 5);
+        REQUIRE(true == cmp(v, std::vector<int>{1, 7, 5, 5}));
+        auto w = small_vector<int, 8>{4};
+        swap(v, w);
+        REQUIRE(true == cmp(w, std::vector<int>{1, 7, 5, 5}));
+        REQUIRE(true == cmp(v, std::vector<int>{4}));
+    }
+    {
+        // growing reads the new elements from the old storage before moving it, inline to heap and heap to heap
+        const auto a = std::string(32, 'a');
+        const auto b = std::string(32, 'b');
+        auto v = small_vector<std::string, 2>{a, b};
+        v.push_back(v.front());
+        REQUIRE(!v.is_inline());
+        REQUIRE(true == cmp(v, std::vector<std::string>{a, b, a}));
+        v.push_back(v.back());
+        REQUIRE(4 == v.capacity());
+        v.push_back(v[1]);
+        REQUIRE(8 == v.capacity());
+        REQUIRE(true == cmp(v, std::vector<std::string>{a, b, a, a, b}));
+
+        auto w = small_vector<std::string, 2>{a, b};
+        w.insert(w.begin() + 1, w.begin(), w.end());
+        REQUIRE(true == cmp(w, std::vector<std::string>{a, a, b, b}));
+        w.insert(w.end(), w.begin(), w.end());
+        REQUIRE(true == cmp(w, std::vector<std::string>{a, a, b, b, a, a, b, b}));
+    }
+}
+
+TEST_CASE("test_static_vector()", "[small vector]") {
+    using mleivo::cu::static_vector;
+    static_assert(!mleivo::type_traits::has_method_reserve_v<static_vector<int, 4>>);
+    auto v = static_vector<std::string, 3>{"a", "b"};
+    v.push_back("c");
+    REQUIRE(3 == v.size());
+    REQUIRE(3 == v.capacity());
+    REQUIRE(stored_inside(v));
+    auto moved = std::move(v);
+    REQUIRE(true == cmp(moved, std::vector<std::string>{"a", "b", "c"}));
+    moved.erase(moved.begin());
+    moved.push_back("d");
+    REQUIRE(true == cmp(moved, std::vector<std::string>{"b", "c", "d"}));
+}
+
+TEST_CASE("test_small_vector_container_utils()", "[small vector]") {
+    using namespace mleivo;
+    const auto in = std::vector<int>{1, 2, 3, 4, 5, 6};
+    {
+        auto even = cu::filter<cu::small_vector<int, 4>>(in, [](int i) { return i % 2 == 0; });
+        static_assert(std::is_same_v<cu::small_vector<int, 4>, decltype(even)>);
+        REQUIRE(true == cmp(even, std::vector<int>{2, 4, 6}));
+        REQUIRE(even.is_inline());
+    }
+    {
+        auto squares = cu::transform<cu::static_vector<int, 6>>(in, [](int i) { return i * i; });
+        REQUIRE(true == cmp(squares, std::vector<int>{1, 4, 9, 16, 25, 36}));
+        auto merged = cu::merge<cu::small_vector<int, 4>>(squares, cu::small_vector<int, 2>{7});
+        REQUIRE(true == cmp(merged, std::vector<int>{1, 4, 9, 16, 25, 36, 7}));
+        auto same = cu::merge(cu::small_vector<int, 2>{1}, cu::small_vector<int, 2>{2, 3});
+        REQUIRE(true == cmp(same, std::vector<int>{1, 2, 3}));
+    }
+    {
+        using piece_t = cu::small_vector<char, 8>;
+        auto pieces = cu::split<std::vector<piece_t>>(std::string("ab,cde,"), ',');
+        REQUIRE(3 == pieces.size());
+        REQUIRE(pieces[1] == piece_t{'c', 'd', 'e'});
+        REQUIRE(pieces[2].empty());
+
+        auto same_type = cu::split(piece_t{'x', ';', 'y'}, ';');
+        static_assert(std::is_same_v<std::vector<piece_t>, decltype(same_type)>);
+        REQUIRE(same_type[1] == piece_t{'y'});
+    }
+    {
+        auto out = cu::static_vector<int, 8>{};
+        cu::filter_into(out, in, [](int i) { return i > 4; });
+        cu::transform_into(out, std::vector<int>{1}, [](int i) { return -i; });
+        REQUIRE(true == cmp(out, std::vector<int>{5, 6, -1}));
+        REQUIRE(cu::contains(out, -1));
+    }
+}
@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "containerutils.h"
+#include "static_map.h"
+
+namespace {
+enum class field { id, name, price, quantity };
+
+constexpr auto fields = mleivo::cu::make_static_map<std::string_view, field>(
+    {{"id", field::id}, {"name", field::name}, {"price", field::price}, {"quantity", field::quantity}});
+
+static_assert(fields.size() == 4);
+static_assert(fields.contains("price"));
+static_assert(!fields.contains("pric"));
+static_assert(fields.at("quantity") == field::quantity);
+static_assert(fields.find("id")->second == field::id);
+
+constexpr auto primes = mleivo::cu::make_static_set<int>({2, 3, 5, 7, 11, 13});
+static_assert(primes.contains(11) && !primes.contains(9));
+static_assert(mleivo::cu::make_static_set<field>({field::id, field::price}).contains(field::price));
+} // namespace
+
+TEST_CASE("test_static_map()", "[static map]") {
+    REQUIRE(field::name == fields.at(std::string("name")));
+    REQUIRE(fields.end() == fields.find(std::string_view("names")));
+    REQUIRE_THROWS_AS(fields.at("missing"), std::out_of_range);
+    auto keys = std::vector<std::string_view>{};
+    for (const auto& [key, value] : fields)
+        keys.push_back(key);
+    REQUIRE(keys == std::vector<std::string_view>{"id", "name", "price", "quantity"});
+
+    REQUIRE(primes.contains(13));
+    REQUIRE(0 == primes.count(1));
+
+    constexpr auto empty = mleivo::cu::static_set<int, 0>(std::array<int, 0>{});
+    static_assert(empty.empty() && !empty.contains(0));
+
+    // runtime construction takes the same path, and rejects what would not compile as constexpr
+    REQUIRE_THROWS_AS(mleivo::cu::make_static_set<int>({1, 2, 1}), std::invalid_argument);
+}
+
+TEST_CASE("test_static_map_many_keys()", "[static map]") {
+    // every key found, and no miss of the same length
+    auto names = std::vector<std::string>{};
+    for (int i = 0; i < 300; ++i)
+        names.push_back("field_" + std::to_string(i));
+    auto items = std::array<std::string_view, 300>{};
+    for (std::size_t i = 0; i < items.size(); ++i)
+        items[i] = names[i];
+    const auto set = mleivo::cu::static_set<std::string_view, 300>(items);
+    for (std::size_t i = 0; i < names.size(); ++i)
+        REQUIRE(set.begin() + i == set.find(names[i]));
+    for (int i = 300; i < 1300; ++i)
+        REQUIRE(!set.contains("field_" + std::to_string(i)));
+
+    auto ints = std::array<int, 200>{};
+    for (std::size_t i = 0; i < ints.size(); ++i)
+        ints[i] = static_cast<int>(i * 7919);
+    const auto int_set = mleivo::cu::static_set<int, 200>(ints);
+    auto found = std::unordered_set<int>(ints.begin(), ints.end());
+    for (int i = -10; i < 200 * 7919 + 10; i += 13)
+        REQUIRE(found.count(i) == int_set.count(i));
+}
+
+TEST_CASE("test_static_map_container_utils()", "[static map]") {
+    REQUIRE(mleivo::cu::contains(fields, "name"));
+    REQUIRE(!mleivo::cu::contains(fields, std::string("title")));
+    REQUIRE(mleivo::cu::contains(primes, 7));
+    REQUIRE(mleivo::cu::filter(std::vector<int>{1, 2, 3, 4, 5, 6}, [](int v) { return primes.contains(v); })
+            == std::vector<int>{2, 3, 5});
+}
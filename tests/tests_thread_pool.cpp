@@ -0,0 +1,206 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "helpers.h"
+#include "pipes.h"
+#include "thread_pool.h"
+
+namespace {
+std::uint64_t fib(mleivo::exec::thread_pool& pool, int n) {
+    if (n < 2)
+        return static_cast<std::uint64_t>(n);
+    auto a = std::uint64_t{0};
+    auto b = std::uint64_t{0};
+    pool.fork_join([&] { a = fib(pool, n - 1); }, [&] { b = fib(pool, n - 2); });
+    return a + b;
+}
+} // namespace
+
+TEST_CASE("test_thread_pool()", "[thread pool]") {
+    auto pool = mleivo::exec::thread_pool(4);
+    REQUIRE(4 == pool.size());
+    REQUIRE(6765 == fib(pool, 20));
+
+    // every fork ran once, on some worker
+    auto ran = std::vector<std::atomic<int>>(1000);
+    const std::function<void(std::size_t, std::size_t)> each = [&](std::size_t first, std::size_t last) {
+        if (last - first == 1) {
+            ++ran[first];
+            return;
+        }
+        const auto mid = first + (last - first) / 2;
+        pool.fork_join([&] { each(first, mid); }, [&] { each(mid, last); });
+    };
+    pool.run([&] { each(0, ran.size()); });
+    REQUIRE(std::all_of(ran.begin(), ran.end(), [](const auto& r) { return r == 1; }));
+
+    // exceptions reach the caller once both branches are done
+    auto other_done = false;
+    REQUIRE_THROWS_AS(pool.fork_join([] { throw std::runtime_error("a"); },
+                                     [&] {
+                                         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                                         other_done = true;
+                                     }),
+                      std::runtime_error);
+    REQUIRE(other_done);
+    REQUIRE_THROWS_AS(pool.run([] { throw std::logic_error("run"); }), std::logic_error);
+
+    // a pool is usable from several outside threads at once
+    auto sums = std::vector<std::uint64_t>(4);
+    auto callers = std::vector<std::thread>{};
+    for (std::size_t i = 0; i < sums.size(); ++i)
+        callers.emplace_back([&, i] { pool.run([&] { sums[i] = fib(pool, 15 + static_cast<int>(i)); }); });
+    for (auto& t : callers)
+        t.join();
+    REQUIRE(true == cmp(std::vector<std::uint64_t>{610, 987, 1597, 2584}, sums));
+}
+
+TEST_CASE("test_work_deque_stress()", "[thread pool]") {
+    // the owner pushes and pops while thieves steal, every job is taken exactly once
+    constexpr auto jobs = std::size_t{200'000};
+    auto items = std::vector<mleivo::exec::detail::job>(jobs, mleivo::exec::detail::job{nullptr});
+    auto taken = std::vector<std::atomic<int>>(jobs);
+    auto deque = mleivo::exec::detail::work_deque{};
+    auto done = std::atomic<bool>{false};
+    auto stolen = std::atomic<std::size_t>{0};
+    const auto take = [&](mleivo::exec::detail::job* j) { ++taken[static_cast<std::size_t>(j - items.data())]; };
+    auto thieves = std::vector<std::thread>{};
+    for (int t = 0; t < 3; ++t) {
+        thieves.emplace_back([&] {
+            while (!done.load()) {
+                if (auto* j = deque.steal()) {
+                    take(j);
+                    ++stolen;
+                }
+            }
+        });
+    }
+    auto rng = std::mt19937(9);
+    for (std::size_t i = 0; i < jobs; ++i) {
+        deque.push(&items[i]);
+        // bursts of pushes grow the ring, pops race the thieves for the last jobs
+        if (rng() % 3 == 0) {
+            if (auto* j = deque.pop())
+                take(j);
+        }
+    }
+    while (auto* j = deque.pop())
+        take(j);
+    done = true;
+    for (auto& t : thieves)
+        t.join();
+    while (auto* j = deque.steal())
+        take(j);
+    REQUIRE(std::all_of(taken.begin(), taken.end(), [](const auto& t) { return t == 1; }));
+}
+
+TEST_CASE("test_thread_pool_stress()", "[thread pool]") {
+    // nested forks from several outside threads at once, on pools big and small and pinned
+    for (const auto options : {mleivo::exec::thread_pool_options{1, false}, mleivo::exec::thread_pool_options{3, false},
+                               mleivo::exec::thread_pool_options{8, true}}) {
+        auto pool = mleivo::exec::thread_pool(options);
+        auto callers = std::vector<std::thread>{};
+        auto failures = std::atomic<int>{0};
+        for (int c = 0; c < 4; ++c) {
+            callers.emplace_back([&] {
+                for (int round = 0; round < 20; ++round) {
+                    if (fib(pool, 14) != 377)
+                        ++failures;
+                }
+            });
+        }
+        for (auto& t : callers)
+            t.join();
+        REQUIRE(0 == failures);
+    }
+}
+
+TEST_CASE("test_parallel_for_reduce()", "[thread pool]") {
+    auto pool = mleivo::exec::thread_pool(4);
+    auto v = std::vector<std::uint64_t>(100'000);
+    mleivo::exec::parallel_for(pool, 0, v.size(), [&v](std::size_t i) { v[i] = i; }, 100);
+    for (std::size_t i = 0; i < v.size(); ++i)
+        REQUIRE(i == v[i]);
+    mleivo::exec::parallel_for(5, 5, [](std::size_t) { FAIL(); });
+
+    const auto sum = mleivo::exec::parallel_reduce(
+        pool, 0, v.size(), std::uint64_t{0},
+        [&v](std::size_t first, std::size_t last, std::uint64_t acc) {
+            for (auto i = first; i < last; ++i)
+                acc += v[i];
+            return acc;
+        },
+        std::plus<>{}, 1000);
+    REQUIRE(std::uint64_t{99'999} * 100'000 / 2 == sum);
+
+    // combine joins the pieces in order, so a non-commutative one works
+    const auto digits = mleivo::exec::parallel_reduce(
+        0, 10, std::string{},
+        [](std::size_t first, std::size_t last, std::string acc) {
+            for (auto i = first; i < last; ++i)
+                acc += static_cast<char>('0' + i);
+            return acc;
+        },
+        std::plus<>{});
+    REQUIRE("0123456789" == digits);
+    REQUIRE(7 == mleivo::exec::parallel_reduce(3, 3, 7, [](auto, auto, int) { return 0; }, std::plus<>{}));
+
+    // pipe stages under a parallel policy run on the global pool
+    v | mleivo::pipes::par | mleivo::pipes::for_each([](std::uint64_t& i) { i *= 2; });
+    for (std::size_t i = 0; i < v.size(); ++i)
+        REQUIRE(2 * i == v[i]);
+}
+
+TEST_CASE("test_parallel_merge_sort()", "[thread pool]") {
+    auto pool = mleivo::exec::thread_pool(4);
+    auto rng = std::mt19937(5);
+    for (const auto n : {std::size_t{0}, std::size_t{1000}, std::size_t{100'000}, std::size_t{250'001}}) {
+        auto v = std::vector<std::pair<int, std::size_t>>(n);
+        for (std::size_t i = 0; i < n; ++i)
+            v[i] = {static_cast<int>(rng() % 1000), i};
+        // by the first only, so ties have to keep their order
+        auto comp = [](const auto& a, const auto& b) { return a.first < b.first; };
+        auto expected = v;
+        std::stable_sort(expected.begin(), expected.end(), comp);
+        mleivo::pipes::detail::parallel_sort<true>(pool, v.begin(), v.end(), comp);
+        REQUIRE(expected == v);
+    }
+    {
+        auto v = std::vector<int>(200'000);
+        for (auto& i : v)
+            i = static_cast<int>(rng());
+        auto comp = std::greater<>{};
+        mleivo::pipes::detail::parallel_sort<false>(pool, v.begin(), v.end(), comp);
+        REQUIRE(std::is_sorted(v.begin(), v.end(), std::greater<>{}));
+    }
+}
+
+TEST_CASE("test_pipe_sort_projection()", "[thread pool]") {
+    namespace pipes = mleivo::pipes;
+    struct record {
+        int id;
+        int seq;
+    };
+    auto v = std::vector<record>{{3, 0}, {1, 1}, {3, 2}, {2, 3}, {1, 4}};
+    const auto seqs = [](const std::vector<record>& r) {
+        auto out = std::vector<int>{};
+        for (const auto& e : r)
+            out.push_back(e.seq);
+        return out;
+    };
+    v | pipes::stable_sort(std::less<>{}, &record::id);
+    REQUIRE(true == cmp(std::vector<int>{1, 4, 3, 0, 2}, seqs(v)));
+    v | pipes::par | pipes::stable_sort(std::greater<>{}, [](const record& r) { return r.id; });
+    REQUIRE(true == cmp(std::vector<int>{0, 2, 3, 1, 4}, seqs(v)));
+    v | pipes::sort(pipes::par_unseq, std::less<>{}, &record::seq);
+    REQUIRE(true == cmp(std::vector<int>{0, 1, 2, 3, 4}, seqs(v)));
+}
@@ -0,0 +1,409 @@
+/*
+ * Copyright 2023 Marcus Leivo
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace mleivo::exec {
+namespace detail {
+// a unit of work in the pool's deques, run once by whichever thread pops or steals it
+struct job {
+    void (*m_run)(job*);
+};
+
+// the second branch of a fork_join, it lives on the stack of the forking thread, which waits for m_done
+template <typename F>
+struct stack_job : job {
+    explicit stack_job(F& f) : job{&stack_job::run}, m_f(f) {
+    }
+
+    static void run(job* j) {
+        auto* self = static_cast<stack_job*>(j);
+        try {
+            self->m_f();
+        } catch (...) {
+            self->m_error = std::current_exception();
+        }
+        self->m_done.store(true, std::memory_order_release);
+    }
+
+    F& m_f;
+    std::exception_ptr m_error;
+    std::atomic<bool> m_done{false};
+};
+
+// a worker's deque, the lock-free one of Chase and Lev with the memory orders of Le et al. The owner pushes and pops
+// jobs at the bottom without contention unless a single job is left, thieves take the oldest job at the top with a
+// compare and swap. A full ring is replaced by one twice the size, kept until the deque goes as thieves may still read
+class work_deque {
+public:
+    work_deque() {
+        m_rings.push_back(std::make_unique<ring>(256));
+        m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+    }
+
+    // owner only
+    void push(job* j) {
+        const auto b = m_bottom.load(std::memory_order_relaxed);
+        const auto t = m_top.load(std::memory_order_acquire);
+        auto* r = m_ring.load(std::memory_order_relaxed);
+        if (b - t > static_cast<std::int64_t>(r->m_mask)) {
+            auto grown = std::make_unique<ring>(2 * (r->m_mask + 1));
+            for (auto i = t; i < b; ++i)
+                grown->put(i, r->get(i));
+            r = grown.get();
+            m_rings.push_back(std::move(grown));
+            m_ring.store(r, std::memory_order_release);
+        }
+        r->put(b, j);
+        m_bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // owner only
+    job* pop() {
+        const auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+        auto* r = m_ring.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = m_top.load(std::memory_order_relaxed);
+        if (t > b) {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        auto* j = r->get(b);
+        if (t == b) {
+            // the last job, a thief may be taking it too
+            if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                j = nullptr;
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return j;
+    }
+
+    // any thread, nullptr when empty or when another thread took the job first
+    job* steal() {
+        auto t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto b = m_bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+        auto* j = m_ring.load(std::memory_order_acquire)->get(t);
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return j;
+    }
+
+private:
+    struct ring {
+        explicit ring(std::size_t size) : m_mask(size - 1), m_jobs(std::make_unique<std::atomic<job*>[]>(size)) {
+        }
+        job* get(std::int64_t i) const {
+            return m_jobs[static_cast<std::size_t>(i) & m_mask].load(std::memory_order_relaxed);
+        }
+        void put(std::int64_t i, job* j) {
+            m_jobs[static_cast<std::size_t>(i) & m_mask].store(j, std::memory_order_relaxed);
+        }
+
+        std::size_t m_mask;
+        std::unique_ptr<std::atomic<job*>[]> m_jobs;
+    };
+
+    alignas(64) std::atomic<std::int64_t> m_top{0};
+    alignas(64) std::atomic<std::int64_t> m_bottom{0};
+    std::atomic<ring*> m_ring{nullptr};
+    std::vector<std::unique_ptr<ring>> m_rings;
+};
+
+// jobs from threads outside the pool, which may not touch the workers' deques
+class injection_queue {
+public:
+    void push(job* j) {
+        const auto lock = std::lock_guard(m_mutex);
+        m_jobs.push_back(j);
+    }
+    job* pop() {
+        const auto lock = std::lock_guard(m_mutex);
+        if (m_jobs.empty())
+            return nullptr;
+        auto* j = m_jobs.front();
+        m_jobs.pop_front();
+        return j;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::deque<job*> m_jobs;
+};
+} // namespace detail
+
+struct thread_pool_options {
+    std::size_t threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    // worker i runs only on cpu i modulo the hardware threads, on Linux, so its deque and data stay in one core's cache
+    bool pin_threads = false;
+};
+
+// thread_pool: fork-join parallelism on a fixed set of workers. A fork pushes its second branch to the forking
+// worker's own deque and runs the first; idle workers steal the oldest, so the biggest, pieces of work from the others.
+// A worker waiting for a stolen branch runs other jobs in the meantime instead of blocking
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t threads = thread_pool_options{}.threads)
+        : thread_pool(thread_pool_options{threads, false}) {
+    }
+
+    explicit thread_pool(const thread_pool_options& options) {
+        const auto threads = std::max<std::size_t>(options.threads, 1);
+        m_deques.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+            m_deques.push_back(std::make_unique<detail::work_deque>());
+        m_threads.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) {
+            m_threads.emplace_back([this, i] { work(i); });
+            if (options.pin_threads)
+                pin(m_threads.back(), i);
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool() {
+        {
+            const auto lock = std::lock_guard(m_sleep_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& t : m_threads)
+            t.join();
+    }
+
+    // the pool the parallel algorithms run on, with a worker per hardware thread
+    static thread_pool& global() {
+        static auto pool = thread_pool{};
+        return pool;
+    }
+
+    std::size_t size() const noexcept {
+        return m_threads.size();
+    }
+
+    // runs f on the pool and returns when it is done, rethrowing what it threw. On a worker of this pool f runs inline
+    template <typename F>
+    void run(F&& f) {
+        if (t_pool == this) {
+            f();
+            return;
+        }
+        auto done = false;
+        auto done_mutex = std::mutex{};
+        auto done_cv = std::condition_variable{};
+        auto root = [&] {
+            const auto notify = [&] {
+                {
+                    const auto lock = std::lock_guard(done_mutex);
+                    done = true;
+                }
+                done_cv.notify_one();
+            };
+            try {
+                f();
+            } catch (...) {
+                notify();
+                throw;
+            }
+            notify();
+        };
+        auto j = detail::stack_job<decltype(root)>(root);
+        push(&j);
+        {
+            auto lock = std::unique_lock(done_mutex);
+            done_cv.wait(lock, [&done] { return done; });
+        }
+        // the worker sets m_done right after notifying, and j must outlive that
+        while (!j.m_done.load(std::memory_order_acquire))
+            std::this_thread::yield();
+        if (j.m_error)
+            std::rethrow_exception(j.m_error);
+    }
+
+    // runs a and b, in parallel when a worker is free to take b, and returns when both are done. What either threw is
+    // rethrown, a's first
+    template <typename A, typename B>
+    void fork_join(A&& a, B&& b) {
+        if (t_pool != this) {
+            run([&] { fork_join(a, b); });
+            return;
+        }
+        auto j = detail::stack_job<std::remove_reference_t<B>>(b);
+        push(&j);
+        auto error = std::exception_ptr{};
+        try {
+            a();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        // b is most likely still on top of our deque, otherwise help with other work until its thief is done
+        while (!j.m_done.load(std::memory_order_acquire)) {
+            if (auto* other = find_work(t_index))
+                other->m_run(other);
+            else
+                std::this_thread::yield();
+        }
+        if (error)
+            std::rethrow_exception(error);
+        if (j.m_error)
+            std::rethrow_exception(j.m_error);
+    }
+
+private:
+    static void pin([[maybe_unused]] std::thread& t, [[maybe_unused]] std::size_t index) {
+#if defined(__linux__)
+        auto cpus = cpu_set_t{};
+        CPU_ZERO(&cpus);
+        CPU_SET(static_cast<int>(index % std::max<std::size_t>(std::thread::hardware_concurrency(), 1)), &cpus);
+        pthread_setaffinity_np(t.native_handle(), sizeof(cpus), &cpus);
+#endif
+    }
+
+    void push(detail::job* j) {
+        if (t_pool == this)
+            m_deques[t_index]->push(j);
+        else
+            m_injected.push(j);
+        m_queued.fetch_add(1);
+        if (m_sleeping.load() > 0) {
+            const auto lock = std::lock_guard(m_sleep_mutex);
+            m_wake.notify_one();
+        }
+    }
+
+    detail::job* find_work(std::size_t index) {
+        if (auto* j = m_deques[index]->pop()) {
+            m_queued.fetch_sub(1);
+            return j;
+        }
+        if (auto* j = m_injected.pop()) {
+            m_queued.fetch_sub(1);
+            return j;
+        }
+        for (std::size_t i = 1; i < m_deques.size(); ++i) {
+            if (auto* j = m_deques[(index + i) % m_deques.size()]->steal()) {
+                m_queued.fetch_sub(1);
+                return j;
+            }
+        }
+        return nullptr;
+    }
+
+    void work(std::size_t index) {
+        t_pool = this;
+        t_index = index;
+        while (true) {
+            if (auto* j = find_work(index)) {
+                j->m_run(j);
+                continue;
+            }
+            // a push after our search is seen here, a push before it raised m_queued before we went to sleep
+            auto lock = std::unique_lock(m_sleep_mutex);
+            m_sleeping.fetch_add(1);
+            m_wake.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+            m_sleeping.fetch_sub(1);
+            if (m_stop)
+                return;
+        }
+    }
+
+    inline static thread_local thread_pool* t_pool = nullptr;
+    inline static thread_local std::size_t t_index = 0;
+
+    std::vector<std::unique_ptr<detail::work_deque>> m_deques;
+    detail::injection_queue m_injected;
+    std::vector<std::thread> m_threads;
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake;
+    std::atomic<std::size_t> m_sleeping{0};
+    std::atomic<std::size_t> m_queued{0};
+    bool m_stop = false;
+};
+
+// parallel_for: f(i) for every i in [first, last), split in halves down to pieces of grain indices
+template <typename F>
+void parallel_for(thread_pool& pool, std::size_t first, std::size_t last, F&& f, std::size_t grain = 1) {
+    grain = std::max<std::size_t>(grain, 1);
+    const auto split = [&pool, &f, grain](const auto& self, std::size_t begin, std::size_t end) -> void {
+        if (end - begin <= grain) {
+            for (auto i = begin; i < end; ++i)
+                f(i);
+            return;
+        }
+        const auto mid = begin + (end - begin) / 2;
+        pool.fork_join([&] { self(self, begin, mid); }, [&] { self(self, mid, end); });
+    };
+    if (first < last)
+        pool.run([&] { split(split, first, last); });
+}
+
+template <typename F>
+void parallel_for(std::size_t first, std::size_t last, F&& f, std::size_t grain = 1) {
+    parallel_for(thread_pool::global(), first, last, std::forward<F>(f), grain);
+}
+
+// parallel_reduce: reduce(begin, end, identity) folds a piece of [first, last) of at most grain indices into a T, and
+// combine(lhs, rhs) joins the pieces in index order, so combine only has to be associative
+template <typename T, typename Reduce, typename Combine>
+T parallel_reduce(thread_pool& pool, std::size_t first, std::size_t last, T identity, Reduce&& reduce,
+                  Combine&& combine, std::size_t grain = 1) {
+    grain = std::max<std::size_t>(grain, 1);
+    const auto split = [&](const auto& self, std::size_t begin, std::size_t end) -> T {
+        if (end - begin <= grain)
+            return reduce(begin, end, identity);
+        const auto mid = begin + (end - begin) / 2;
+        auto lhs = identity;
+        auto rhs = identity;
+        pool.fork_join([&] { lhs = self(self, begin, mid); }, [&] { rhs = self(self, mid, end); });
+        return combine(std::move(lhs), std::move(rhs));
+    };
+    if (first >= last)
+        return identity;
+    auto out = identity;
+    pool.run([&] { out = split(split, first, last); });
+    return out;
+}
+
+template <typename T, typename Reduce, typename Combine>
+T parallel_reduce(std::size_t first, std::size_t last, T identity, Reduce&& reduce, Combine&& combine,
+                  std::size_t grain = 1) {
+    return parallel_reduce(thread_pool::global(), first, last, std::move(identity), std::forward<Reduce>(reduce),
+                           std::forward<Combine>(combine), grain);
+}
+} // namespace mleivo::exec
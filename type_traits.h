@@ -16,7 +16,10 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <type_traits>
+#include <utility>
 
 #define MLEIVO_RETURN_TYPE(METHOD_NAME, ARGS...) decltype(std::declval<std::decay_t<ContainerT>>().METHOD_NAME(ARGS))
 #define MLEIVO_HAS_METHOD(METHOD_NAME, WANTED_RETURN_TYPE, ARGS...)                                                    \
@@ -30,6 +33,16 @@
     template <typename ContainerT>                                                                                     \
     inline constexpr bool has_method_##METHOD_NAME##_v = has_method_##METHOD_NAME<ContainerT>::value;
 
+// the compiler's builtin, where it has one, compares two types without instantiating anything
+#if defined(__has_builtin)
+#if __has_builtin(__is_same)
+#define MLEIVO_IS_SAME(A, B) __is_same(A, B)
+#endif
+#endif
+#ifndef MLEIVO_IS_SAME
+#define MLEIVO_IS_SAME(A, B) std::is_same_v<A, B>
+#endif
+
 namespace mleivo::type_traits {
 template <typename...>
 inline constexpr bool always_false_v = false;
@@ -38,9 +51,14 @@ inline constexpr bool always_false_v = false;
 template <typename ContainerT>
 using value_type = typename std::decay_t<ContainerT>::value_type;
 
+MLEIVO_HAS_METHOD(capacity, std::size_t)
 MLEIVO_HAS_METHOD(contains, bool, std::declval<value_type<ContainerT>>())
 MLEIVO_HAS_METHOD(count, std::size_t, std::declval<value_type<ContainerT>>())
+MLEIVO_HAS_METHOD(pop_front, void)
 MLEIVO_HAS_METHOD(push_back, void, std::declval<value_type<ContainerT>>())
+MLEIVO_HAS_METHOD(reserve, void, std::declval<std::size_t>())
+MLEIVO_HAS_METHOD(resize, void, std::declval<std::size_t>())
+MLEIVO_HAS_METHOD(size, std::size_t)
 
 // is_predicate
 template <typename Pred, typename... Args>
@@ -60,32 +78,102 @@ public:
 template <typename Pred, typename Arg>
 inline constexpr bool is_unary_predicate_v = is_predicate<Pred, Arg>::value;
 
+// is_hashable
+template <typename T, typename = void>
+struct is_hashable : std::false_type {};
+
+template <typename T>
+struct is_hashable<T, std::void_t<decltype(std::hash<T>{}(std::declval<const T&>()))>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_hashable_v = is_hashable<T>::value;
+
+// is_equality_comparable
+template <typename T, typename = void>
+struct is_equality_comparable : std::false_type {};
+
+template <typename T>
+struct is_equality_comparable<T, std::void_t<decltype(std::declval<const T&>() == std::declval<const T&>())>>
+    : std::is_convertible<decltype(std::declval<const T&>() == std::declval<const T&>()), bool> {};
+
+template <typename T>
+inline constexpr bool is_equality_comparable_v = is_equality_comparable<T>::value;
+
+// is_less_than_comparable
+template <typename T, typename = void>
+struct is_less_than_comparable : std::false_type {};
+
+template <typename T>
+struct is_less_than_comparable<T, std::void_t<decltype(std::declval<const T&>() < std::declval<const T&>())>>
+    : std::is_convertible<decltype(std::declval<const T&>() < std::declval<const T&>()), bool> {};
+
+template <typename T>
+inline constexpr bool is_less_than_comparable_v = is_less_than_comparable<T>::value;
+
+// nth_type
+namespace detail {
+template <std::size_t I, typename T>
+struct indexed_type {
+    using type = T;
+};
+
+template <typename IndexSequence, typename... Ts>
+struct indexed_types;
+
+template <std::size_t... I, typename... Ts>
+struct indexed_types<std::index_sequence<I...>, Ts...> : indexed_type<I, Ts>... {};
+
+// overload resolution picks the one base with index I, so no instantiation recurses through the pack
+template <std::size_t I, typename T>
+indexed_type<I, T> select_indexed(const indexed_type<I, T>&);
+} // namespace detail
+
+template <std::size_t I, typename... Ts>
+using nth_type = typename decltype(detail::select_indexed<I>(
+    std::declval<detail::indexed_types<std::index_sequence_for<Ts...>, Ts...>>()))::type;
+
 // type_map
+namespace detail {
+// the index of the value paired with the first Key, or the size of the pack without one
+template <typename Key, typename... KeyValues, std::size_t... I>
+constexpr std::size_t value_index(std::index_sequence<I...>) {
+    constexpr bool matches[] = {(I % 2 == 0 && MLEIVO_IS_SAME(Key, KeyValues))..., true};
+    std::size_t i = 0;
+    while (!matches[i])
+        ++i;
+    return i == sizeof...(I) ? i : i + 1;
+}
+
+template <typename Key, typename... KeyValues>
+inline constexpr std::size_t value_index_v = value_index<Key, KeyValues...>(std::index_sequence_for<KeyValues...>{});
+
+// the pack stays the same for every key, so all lookups share one indexed_types
+template <typename Key, bool Found, std::size_t I, typename... KeyValues>
+struct type_map_value {
+    using type = nth_type<I, KeyValues...>;
+};
+
+template <typename Key, std::size_t I, typename... KeyValues>
+struct type_map_value<Key, false, I, KeyValues...> {
+    using type = std::enable_if<always_false_v<Key>>;
+};
+} // namespace detail
+
 template <typename Key1, typename Value1, typename... KeyValues>
 struct type_map {
-    template <typename Key>
-    using value =
-        std::conditional_t<std::is_same_v<Key, Key1>, Value1, typename type_map<KeyValues...>::template value<Key>>;
-};
+    static_assert(sizeof...(KeyValues) % 2 == 0, "type_map takes key value pairs");
 
-template <typename Key1, typename Value1>
-struct type_map<Key1, Value1> {
+    // the value of the first pair with Key, std::enable_if<false> without one
     template <typename Key>
-    using value = std::conditional_t<std::is_same_v<Key, Key1>, Value1, std::enable_if<always_false_v<Key>>>;
+    using value = typename detail::type_map_value<
+        Key, detail::value_index_v<Key, Key1, Value1, KeyValues...> != sizeof...(KeyValues) + 2,
+        detail::value_index_v<Key, Key1, Value1, KeyValues...>, Key1, Value1, KeyValues...>::type;
 };
 
 // value_types_are_equal
 template <typename ContainerT1, typename... ContainerT2ToN>
-struct value_types_equal;
-
-template <typename ContainerT>
-struct value_types_equal<ContainerT> : std::true_type {};
-
-template <typename ContainerT1, typename ContainerT2, typename... ContainerT3ToN>
-struct value_types_equal<ContainerT1, ContainerT2, ContainerT3ToN...>
-    : std::bool_constant<
-          std::is_same_v<typename std::decay_t<ContainerT1>::value_type, typename std::decay_t<ContainerT2>::value_type>
-          && value_types_equal<ContainerT2, ContainerT3ToN...>::value> {};
+struct value_types_equal
+    : std::bool_constant<(std::is_same_v<value_type<ContainerT1>, value_type<ContainerT2ToN>> && ...)> {};
 
 template <typename ContainerT1, typename... ContainerT2ToN>
 inline constexpr bool value_types_equal_v = value_types_equal<ContainerT1, ContainerT2ToN...>::value;